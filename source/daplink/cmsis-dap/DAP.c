@@ -34,6 +34,7 @@
 #endif
 #include "DAP_config.h"
 #include "DAP.h"
+#include "dap_profile.h"
 
 
 #define DAP_FW_VER      "1.10"  // Firmware Version
@@ -129,7 +130,8 @@ static uint8_t DAP_Info(uint8_t id, uint8_t *info) {
                 ((DAP_JTAG != 0)       ? (1U << 1) : 0U) |
                 ((SWO_UART != 0)       ? (1U << 2) : 0U) |
                 ((SWO_MANCHESTER != 0) ? (1U << 3) : 0U) |
-                /* Atomic Commands  */   (1U << 4);
+                /* Atomic Commands  */   (1U << 4) |
+                ((SWO_STREAM != 0)     ? (1U << 6) : 0U);
       length = 1U;
       break;
     case DAP_ID_SWO_BUFFER_SIZE:
@@ -1117,18 +1119,52 @@ static uint32_t DAP_Transfer(const uint8_t *request, uint8_t *response) {
 }
 
 
+#if (DAP_SWD != 0)
+// Repeat a SWD transfer while the target answers WAIT
+//   request: A[3:2] RnW APnDP
+//   data:    DATA[31:0]
+//   ack:     response of the first attempt
+//   return:  ACK[2:0] of the last attempt
+static uint32_t DAP_SWD_TransferRetry(uint32_t request, uint32_t *data, uint32_t ack) {
+  uint32_t retry;
+
+  retry = DAP_Data.transfer.retry_count;
+  while ((ack == DAP_TRANSFER_WAIT) && retry-- && !DAP_TransferAbort) {
+    ack = SWD_Transfer(request, data);
+  }
+  return (ack);
+}
+
+
+// Store a word of read data in the response
+//   response: pointer to response data
+//   data:     DATA[31:0]
+//   return:   pointer past the stored data
+// A word aligned response takes the data with one store, the Cortex-M is
+// little-endian like the response. Otherwise it is packed byte by byte.
+static __inline uint8_t *DAP_StoreData(uint8_t *response, uint32_t data) {
+  if (((uint32_t)response & 3U) == 0U) {
+    *(uint32_t *)response = data;
+  } else {
+    *(response+0) = (uint8_t) data;
+    *(response+1) = (uint8_t)(data >>  8);
+    *(response+2) = (uint8_t)(data >> 16);
+    *(response+3) = (uint8_t)(data >> 24);
+  }
+  return (response + 4);
+}
+
+
 // Process SWD Transfer Block command and prepare response
 //   request:  pointer to request data
 //   response: pointer to response data
 //   return:   number of bytes in response
-#if (DAP_SWD != 0)
 static uint32_t DAP_SWD_TransferBlock(const uint8_t *request, uint8_t *response) {
   uint32_t  request_count;
   uint32_t  request_value;
   uint32_t  response_count;
   uint32_t  response_value;
   uint8_t  *response_head;
-  uint32_t  retry;
   uint32_t  data;
 
   response_count = 0U;
@@ -1144,33 +1180,42 @@ static uint32_t DAP_SWD_TransferBlock(const uint8_t *request, uint8_t *response)
   request += 2;
   if (request_count == 0U) { goto end; }
 
+  // Each word is transferred once; the retry loop is only entered
+  // when the target does not answer OK
   request_value = *request++;
   if (request_value & DAP_TRANSFER_RnW) {
     // Read register block
     if (request_value & DAP_TRANSFER_APnDP) {
       // Post AP read
-      retry = DAP_Data.transfer.retry_count;
-      do {
-        response_value = SWD_Transfer(request_value, NULL);
-      } while ((response_value == DAP_TRANSFER_WAIT) && retry-- && !DAP_TransferAbort);
-      if (response_value != DAP_TRANSFER_OK) { goto end; }
+      response_value = SWD_Transfer(request_value, NULL);
+      if (response_value != DAP_TRANSFER_OK) {
+        response_value = DAP_SWD_TransferRetry(request_value, NULL, response_value);
+        if (response_value != DAP_TRANSFER_OK) { goto end; }
+      }
+      // Data of the last AP read is returned by RDBUFF
+      request_count--;
     }
     while (request_count--) {
       // Read DP/AP register
-      if ((request_count == 0U) && (request_value & DAP_TRANSFER_APnDP)) {
-        // Last AP read
-        request_value = DP_RDBUFF | DAP_TRANSFER_RnW;
+      response_value = SWD_Transfer(request_value, &data);
+      if (response_value != DAP_TRANSFER_OK) {
+        response_value = DAP_SWD_TransferRetry(request_value, &data, response_value);
+        if (response_value != DAP_TRANSFER_OK) { goto end; }
       }
-      retry = DAP_Data.transfer.retry_count;
-      do {
-        response_value = SWD_Transfer(request_value, &data);
-      } while ((response_value == DAP_TRANSFER_WAIT) && retry-- && !DAP_TransferAbort);
-      if (response_value != DAP_TRANSFER_OK) { goto end; }
       // Store data
-      *response++ = (uint8_t) data;
-      *response++ = (uint8_t)(data >>  8);
-      *response++ = (uint8_t)(data >> 16);
-      *response++ = (uint8_t)(data >> 24);
+      response = DAP_StoreData(response, data);
+      response_count++;
+    }
+    if (request_value & DAP_TRANSFER_APnDP) {
+      // Last AP read
+      request_value = DP_RDBUFF | DAP_TRANSFER_RnW;
+      response_value = SWD_Transfer(request_value, &data);
+      if (response_value != DAP_TRANSFER_OK) {
+        response_value = DAP_SWD_TransferRetry(request_value, &data, response_value);
+        if (response_value != DAP_TRANSFER_OK) { goto end; }
+      }
+      // Store data
+      response = DAP_StoreData(response, data);
       response_count++;
     }
   } else {
@@ -1183,18 +1228,18 @@ static uint32_t DAP_SWD_TransferBlock(const uint8_t *request, uint8_t *response)
              (*(request+3) << 24);
       request += 4;
       // Write DP/AP register
-      retry = DAP_Data.transfer.retry_count;
-      do {
-        response_value = SWD_Transfer(request_value, &data);
-      } while ((response_value == DAP_TRANSFER_WAIT) && retry-- && !DAP_TransferAbort);
-      if (response_value != DAP_TRANSFER_OK) { goto end; }
+      response_value = SWD_Transfer(request_value, &data);
+      if (response_value != DAP_TRANSFER_OK) {
+        response_value = DAP_SWD_TransferRetry(request_value, &data, response_value);
+        if (response_value != DAP_TRANSFER_OK) { goto end; }
+      }
       response_count++;
     }
     // Check last write
-    retry = DAP_Data.transfer.retry_count;
-    do {
-      response_value = SWD_Transfer(DP_RDBUFF | DAP_TRANSFER_RnW, NULL);
-    } while ((response_value == DAP_TRANSFER_WAIT) && retry-- && !DAP_TransferAbort);
+    response_value = SWD_Transfer(DP_RDBUFF | DAP_TRANSFER_RnW, NULL);
+    if (response_value != DAP_TRANSFER_OK) {
+      response_value = DAP_SWD_TransferRetry(DP_RDBUFF | DAP_TRANSFER_RnW, NULL, response_value);
+    }
   }
 
 end:
@@ -1447,7 +1492,11 @@ __weak uint32_t DAP_ProcessVendorCommand(const uint8_t *request, uint8_t *respon
 //   response: pointer to response data
 //   return:   number of bytes in response (lower 16 bits)
 //             number of bytes in request (upper 16 bits)
+#if (DAP_PROFILE != 0)
+static uint32_t DAP_ProcessCommandUntimed(const uint8_t *request, uint8_t *response) {
+#else
 uint32_t DAP_ProcessCommand(const uint8_t *request, uint8_t *response) {
+#endif
   uint32_t num;
 
   if ((*request >= ID_DAP_Vendor0) && (*request <= ID_DAP_Vendor31)) {
@@ -1549,6 +1598,24 @@ uint32_t DAP_ProcessCommand(const uint8_t *request, uint8_t *response) {
 }
 
 
+#if (DAP_PROFILE != 0)
+// Process DAP command request and account its execution time
+//   request:  pointer to request data
+//   response: pointer to response data
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+uint32_t DAP_ProcessCommand(const uint8_t *request, uint8_t *response) {
+  uint32_t start;
+  uint32_t num;
+
+  start = dap_profile_time();
+  num = DAP_ProcessCommandUntimed(request, response);
+  dap_profile_command(*request, dap_profile_time() - start);
+  return (num);
+}
+#endif
+
+
 // Execute DAP command (process request and prepare response)
 //   request:  pointer to request data
 //   response: pointer to response data
@@ -1557,20 +1624,31 @@ uint32_t DAP_ProcessCommand(const uint8_t *request, uint8_t *response) {
 uint32_t DAP_ExecuteCommand(const uint8_t *request, uint8_t *response) {
   uint32_t cnt, num, n;
 
-  if (*request == ID_DAP_ExecuteCommands) {
-    *response++ = *request++;
+  // Queued commands are held back by the transport and run here in order,
+  // answered the same way as ExecuteCommands
+  if ((*request == ID_DAP_ExecuteCommands) || (*request == ID_DAP_QueueCommands)) {
+    *response++ = ID_DAP_ExecuteCommands;
+    request++;
     cnt = *request++;
     *response++ = (uint8_t)cnt;
     num = (2U << 16) | 2U;
     while (cnt--) {
+      DAP_Data.request_space  = (uint16_t)(DAP_PACKET_SIZE - (num >> 16));
+      DAP_Data.response_space = (uint16_t)(DAP_PACKET_SIZE - (uint16_t)num);
       n = DAP_ProcessCommand(request, response);
       num += n;
       request  += (uint16_t)(n >> 16);
       response += (uint16_t) n;  
+      // Stop at a command that claimed the rest of either packet
+      if (((num >> 16) >= DAP_PACKET_SIZE) || ((uint16_t)num >= DAP_PACKET_SIZE)) {
+        break;
+      }
     }
     return (num);
   }
 
+  DAP_Data.request_space  = DAP_PACKET_SIZE;
+  DAP_Data.response_space = DAP_PACKET_SIZE;
   return DAP_ProcessCommand(request, response);
 }
 
@@ -1595,4 +1673,8 @@ void DAP_Setup(void) {
 #endif
 
   DAP_SETUP();  // Device specific setup
+
+#if (DAP_PROFILE != 0)
+  dap_profile_reset();
+#endif
 }
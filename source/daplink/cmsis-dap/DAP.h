@@ -169,6 +169,7 @@ extern "C" {
 #define DP_SELECT                       0x08U   // Select Register (JTAG R/W & SW W)
 #define DP_RESEND                       0x08U   // Resend (SW Read Only)
 #define DP_RDBUFF                       0x0CU   // Read Buffer (Read Only)
+#define DP_TARGETSEL                    0x0CU   // Target Select (SW Write Only, DPv2)
 
 // JTAG IR Codes
 #define JTAG_ABORT                      0x08U
@@ -214,6 +215,8 @@ typedef struct {
 #endif
   } jtag_dev;
 #endif
+  uint16_t    request_space;                    // Request bytes left from the current command ID on
+  uint16_t    response_space;                   // Response bytes left from the current command ID on
 } DAP_Data_t;
 
 extern          DAP_Data_t DAP_Data;            // DAP Data
@@ -238,6 +241,15 @@ extern uint32_t SWO_Control     (const uint8_t *request, uint8_t *response);
 extern uint32_t SWO_Status                              (uint8_t *response);
 extern uint32_t SWO_Data        (const uint8_t *request, uint8_t *response);
 
+extern void     SWO_Process          (void);
+extern void     SWO_TransferComplete (void);
+
+extern uint32_t SWO_QueueTransfer    (uint8_t *buf, uint32_t num);
+extern void     SWO_AbortTransfer    (void);
+
+extern void     DAP_Lock             (void);
+extern void     DAP_Unlock           (void);
+
 extern uint32_t DAP_ProcessVendorCommand (const uint8_t *request, uint8_t *response);
 extern uint32_t DAP_ProcessCommand       (const uint8_t *request, uint8_t *response);
 extern uint32_t DAP_ExecuteCommand       (const uint8_t *request, uint8_t *response);
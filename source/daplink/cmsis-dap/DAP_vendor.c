@@ -29,8 +29,28 @@
 #include "DAP.h"
 #include "info.h"
 #include "main.h"
+#include "swd_host.h"
+#include "crc.h"
+#include "flash_manager.h"
+#include "flash_intf.h"
+#include "target_config.h"
+#include "dap_profile.h"
+#include "tasks.h"
 #include <string.h>
 
+// Target memory is moved through the HIC in chunks of this size
+#define DAP_VENDOR_MEM_CHUNK    256U
+
+static uint8_t mem_buf[DAP_VENDOR_MEM_CHUNK];
+
+#if (DAP_VENDOR_FLASH != 0)
+// Flash session open flags
+#define DAP_VENDOR_FLASH_PAGE_ERASE (1U << 0)   // Erase sectors as they are written instead of the whole chip
+
+static uint8_t flash_open;
+static bool    flash_page_erase;        // Board setting restored on close
+#endif
+
 //**************************************************************************************************
 /**
 \defgroup DAP_Vendor_Adapt_gr Adapt Vendor Commands
@@ -42,6 +62,345 @@ Vendor Commands. Copy this file to the project folder of the Debug Unit and add
 file to the MDK-ARM project under the file group Configuration.
 */
 
+// Get a little-endian 32-bit value from the request
+static uint32_t get_uint32(const uint8_t *data) {
+  return ((uint32_t)data[0] <<  0) |
+         ((uint32_t)data[1] <<  8) |
+         ((uint32_t)data[2] << 16) |
+         ((uint32_t)data[3] << 24);
+}
+
+// Put a little-endian 32-bit value into the response
+static void put_uint32(uint8_t *data, uint32_t value) {
+  data[0] = (uint8_t)(value >>  0);
+  data[1] = (uint8_t)(value >>  8);
+  data[2] = (uint8_t)(value >> 16);
+  data[3] = (uint8_t)(value >> 24);
+}
+
+// Check that a command fits in what is left of the request and response
+//   request_len:  number of request bytes after the command ID
+//   response_len: number of response bytes after the command ID
+//   return:       1 = fits, 0 = overruns a packet
+// In an ExecuteCommands or QueueCommands batch the command starts past the
+// packet start, DAP_ExecuteCommand keeps the space left in DAP_Data.
+static uint32_t command_fits(uint32_t request_len, uint32_t response_len) {
+  return ((request_len  < DAP_Data.request_space) &&
+          (response_len < DAP_Data.response_space));
+}
+
+// Lengths of a command that does not fit: it is not executed and answered
+// with its command ID only. It takes up the rest of the request, so
+// DAP_ExecuteCommand does not parse its data as further commands.
+#define COMMAND_OVERRUN     ((uint32_t)(DAP_Data.request_space - 1U) << 16)
+
+// Prepare swd_host for target memory access on behalf of the host
+//   return: 1 = ok, 0 = SWD port not connected
+// The host may have written SELECT and CSW with DAP_Transfer, so the values
+// cached by swd_host are dropped. The commands leave AP 0 selected and CSW
+// set for the access size they used last.
+static uint32_t mem_access_begin(void) {
+  if (DAP_Data.debug_port != DAP_PORT_SWD) {
+    return (0U);
+  }
+  swd_invalidate_dap_state();
+  DAP_TransferAbort = 0U;
+  return (1U);
+}
+
+// Compute the CRC32 of target memory (same CRC as crc32())
+//   request:  address (4 bytes), size in bytes (4 bytes)
+//   response: status (1 byte), CRC32 (4 bytes)
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+static uint32_t DAP_MemoryCRC32(const uint8_t *request, uint8_t *response) {
+  uint32_t addr;
+  uint32_t size;
+  uint32_t crc  = 0U;
+  uint32_t n;
+  uint8_t  status = DAP_ERROR;
+
+  if (!command_fits(8U, 5U)) {
+    return (COMMAND_OVERRUN);
+  }
+  addr = get_uint32(request + 0);
+  size = get_uint32(request + 4);
+
+  if (mem_access_begin()) {
+    while ((size != 0U) && !DAP_TransferAbort) {
+      n = (size < DAP_VENDOR_MEM_CHUNK) ? size : DAP_VENDOR_MEM_CHUNK;
+      if (!swd_read_memory(addr, mem_buf, n)) {
+        break;
+      }
+      crc = crc32_continue(crc, mem_buf, n);
+      addr += n;
+      size -= n;
+    }
+    if (size == 0U) {
+      status = DAP_OK;
+    }
+  }
+
+  response[0] = status;
+  put_uint32(&response[1], crc);
+  return ((8U << 16) | 5U);
+}
+
+// Compare target memory against the data in the request
+//   request:  address (4 bytes), count (2 bytes), data (count bytes)
+//   response: status (1 byte), offset of the first difference (4 bytes)
+//             0xFFFFFFFF if the memory matches
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+static uint32_t DAP_MemoryCompare(const uint8_t *request, uint8_t *response) {
+  uint32_t addr;
+  uint32_t count;
+  const uint8_t *data = request + 6;
+  uint32_t offset = 0U;
+  uint32_t mismatch = 0xFFFFFFFFU;
+  uint32_t n, i;
+  uint8_t  status = DAP_ERROR;
+
+  if (!command_fits(6U, 5U)) {
+    return (COMMAND_OVERRUN);
+  }
+  addr  = get_uint32(request + 0);
+  count = (uint32_t)request[4] | ((uint32_t)request[5] << 8);
+  if (!command_fits(6U + count, 5U)) {
+    return (COMMAND_OVERRUN);
+  }
+
+  if (mem_access_begin()) {
+    while ((offset < count) && (mismatch == 0xFFFFFFFFU) && !DAP_TransferAbort) {
+      n = count - offset;
+      if (n > DAP_VENDOR_MEM_CHUNK) {
+        n = DAP_VENDOR_MEM_CHUNK;
+      }
+      if (!swd_read_memory(addr + offset, mem_buf, n)) {
+        break;
+      }
+      for (i = 0U; i < n; i++) {
+        if (mem_buf[i] != data[offset + i]) {
+          mismatch = offset + i;
+          break;
+        }
+      }
+      offset += n;
+    }
+    if ((offset >= count) || (mismatch != 0xFFFFFFFFU)) {
+      status = DAP_OK;
+    }
+  }
+
+  response[0] = status;
+  put_uint32(&response[1], mismatch);
+  return (((6U + count) << 16) | 5U);
+}
+
+// Fill target memory with a repeated 32-bit pattern
+//   request:  address (4 bytes), size in bytes (4 bytes), pattern (4 bytes)
+//   response: status (1 byte)
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+// The pattern is laid out little-endian from the start address on.
+static uint32_t DAP_MemoryFill(const uint8_t *request, uint8_t *response) {
+  uint32_t addr;
+  uint32_t size;
+  uint32_t n;
+  uint8_t  status = DAP_ERROR;
+
+  if (!command_fits(12U, 1U)) {
+    return (COMMAND_OVERRUN);
+  }
+  addr = get_uint32(request + 0);
+  size = get_uint32(request + 4);
+
+  if (mem_access_begin()) {
+    for (n = 0U; n < DAP_VENDOR_MEM_CHUNK; n++) {
+      mem_buf[n] = request[8U + (n & 3U)];
+    }
+    while ((size != 0U) && !DAP_TransferAbort) {
+      n = (size < DAP_VENDOR_MEM_CHUNK) ? size : DAP_VENDOR_MEM_CHUNK;
+      if (!swd_write_memory(addr, mem_buf, n)) {
+        break;
+      }
+      addr += n;
+      size -= n;
+    }
+    if (size == 0U) {
+      status = DAP_OK;
+    }
+  }
+
+  response[0] = status;
+  return ((12U << 16) | 1U);
+}
+
+#if (DAP_VENDOR_FLASH != 0)
+// Close the flash session, flushing the data buffered by flash_manager
+static error_t flash_close(void) {
+  error_t status;
+
+  status = flash_manager_uninit();
+  flash_manager_set_page_erase(flash_page_erase);
+  flash_manager_release();
+  flash_open = 0U;
+  return status;
+}
+
+// Open a target flash session using the board flash algorithm
+//   request:  flags (1 byte), see DAP_VENDOR_FLASH_*
+//   response: error_t (1 byte)
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+// Programming resets and halts the target, so the host has to connect again
+// once the session is closed. The session is refused with ERROR_FLASH_BUSY
+// while drag-n-drop programming is in progress.
+static uint32_t DAP_FlashOpen(const uint8_t *request, uint8_t *response) {
+  error_t status;
+
+  if (!command_fits(1U, 1U)) {
+    return (COMMAND_OVERRUN);
+  }
+
+  // A session left open by the host is closed first
+  if (flash_open) {
+    flash_close();
+  }
+
+  if (!flash_manager_claim()) {
+    status = ERROR_FLASH_BUSY;
+  } else {
+    flash_page_erase = flash_manager_get_page_erase();
+    flash_manager_set_page_erase((request[0] & DAP_VENDOR_FLASH_PAGE_ERASE) != 0U);
+    status = flash_manager_init(flash_intf_target);
+    if (status == ERROR_SUCCESS) {
+      flash_open = 1U;
+    } else {
+      // flash_manager_init leaves the flash manager closed on failure
+      flash_manager_set_page_erase(flash_page_erase);
+      flash_manager_release();
+    }
+  }
+
+  response[0] = (uint8_t)status;
+  return ((1U << 16) | 1U);
+}
+
+// Program a chunk of data in the open flash session
+//   request:  address (4 bytes), count (2 bytes), data (count bytes)
+//   response: error_t (1 byte)
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+// Chunks must be sent in increasing address order, as for drag-n-drop.
+static uint32_t DAP_FlashWrite(const uint8_t *request, uint8_t *response) {
+  uint32_t addr;
+  uint32_t count;
+  error_t  status;
+
+  if (!command_fits(6U, 1U)) {
+    return (COMMAND_OVERRUN);
+  }
+  addr  = get_uint32(request + 0);
+  count = (uint32_t)request[4] | ((uint32_t)request[5] << 8);
+  if (!command_fits(6U + count, 1U)) {
+    return (COMMAND_OVERRUN);
+  }
+
+  if (!flash_open) {
+    status = ERROR_FAILURE;
+  } else if ((addr < target_device.flash_start) ||
+             (addr > target_device.flash_end) ||
+             (count > (target_device.flash_end - addr))) {
+    status = ERROR_TARGET_OUT_OF_BOUNDS;
+  } else {
+    status = flash_manager_data(addr, request + 6, count);
+  }
+
+  response[0] = (uint8_t)status;
+  return (((6U + count) << 16) | 1U);
+}
+
+// Close the flash session
+//   response: error_t (1 byte) of the last page write
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+static uint32_t DAP_FlashClose(uint8_t *response) {
+  error_t status = ERROR_FAILURE;
+
+  if (!command_fits(0U, 1U)) {
+    return (COMMAND_OVERRUN);
+  }
+
+  if (flash_open) {
+    status = flash_close();
+  }
+
+  response[0] = (uint8_t)status;
+  return (1U);
+}
+#endif
+
+#if (DAP_PROFILE != 0)
+// Read the profile of one DAP command
+//   request:  command ID (1 byte)
+//   response: status (1 byte), calls (4 bytes), total time (4 bytes), max time (4 bytes)
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+static uint32_t DAP_ProfileCommand(const uint8_t *request, uint8_t *response) {
+  const dap_profile_cmd_t *cmd;
+
+  if (!command_fits(1U, 13U)) {
+    return (COMMAND_OVERRUN);
+  }
+
+  cmd = dap_profile_get_command(request[0]);
+  if (cmd == 0) {
+    response[0] = DAP_ERROR;
+    return ((1U << 16) | 1U);
+  }
+
+  response[0] = DAP_OK;
+  put_uint32(response + 1, cmd->calls);
+  put_uint32(response + 5, cmd->total);
+  put_uint32(response + 9, cmd->max);
+  return ((1U << 16) | 13U);
+}
+
+// Read the transport and wire statistics
+//   response: time base in Hz (4 bytes), SWD WAIT count (4 bytes),
+//             SWD FAULT count (4 bytes), request queue high-water mark (1 byte),
+//             response queue high-water mark (1 byte)
+//   return:   number of bytes in response
+static uint32_t DAP_ProfileStatus(uint8_t *response) {
+  const dap_profile_stats_t *stats = dap_profile_get_stats();
+
+  if (!command_fits(0U, 14U)) {
+    return (COMMAND_OVERRUN);
+  }
+
+  put_uint32(response + 0, dap_profile_clock());
+  put_uint32(response + 4, stats->swd_wait);
+  put_uint32(response + 8, stats->swd_fault);
+  response[12] = (uint8_t)stats->request_hwm;
+  response[13] = (uint8_t)stats->response_hwm;
+  return (14U);
+}
+
+// Clear all profiling data
+//   response: status (1 byte)
+//   return:   number of bytes in response
+static uint32_t DAP_ProfileReset(uint8_t *response) {
+  if (!command_fits(0U, 1U)) {
+    return (COMMAND_OVERRUN);
+  }
+
+  dap_profile_reset();
+  response[0] = DAP_OK;
+  return (1U);
+}
+#endif
+
 /** Process DAP Vendor Command and prepare Response Data
 \param request   pointer to request data
 \param response  pointer to response data
@@ -62,13 +421,35 @@ uint32_t DAP_ProcessVendorCommand(const uint8_t *request, uint8_t *response) {
         num += (len + 1); // increment response count by ID length + length byte
         break;
     }
-    case ID_DAP_Vendor1:  break;
-    case ID_DAP_Vendor2:  break;
-    case ID_DAP_Vendor3:  break;
-    case ID_DAP_Vendor4:  break;
-    case ID_DAP_Vendor5:  break;
-    case ID_DAP_Vendor6:  break;
-    case ID_DAP_Vendor7:  break;
+    case ID_DAP_Vendor1:
+      num += DAP_MemoryCRC32(request, response);
+      break;
+    case ID_DAP_Vendor2:
+      num += DAP_MemoryCompare(request, response);
+      break;
+    case ID_DAP_Vendor3:
+      num += DAP_MemoryFill(request, response);
+      break;
+    case ID_DAP_Vendor4:
+#if (DAP_VENDOR_FLASH != 0)
+      num += DAP_FlashOpen(request, response);
+#endif
+      break;
+    case ID_DAP_Vendor5:
+#if (DAP_VENDOR_FLASH != 0)
+      num += DAP_FlashWrite(request, response);
+#endif
+      break;
+    case ID_DAP_Vendor6:
+#if (DAP_VENDOR_FLASH != 0)
+      num += DAP_FlashClose(response);
+#endif
+      break;
+    case ID_DAP_Vendor7:
+#if (DAP_PROFILE != 0)
+      num += DAP_ProfileCommand(request, response);
+#endif
+      break;
     case ID_DAP_Vendor8: {
         *response = 1;
         if (0 == *request) {
@@ -81,8 +462,16 @@ uint32_t DAP_ProcessVendorCommand(const uint8_t *request, uint8_t *response) {
         num += (1U << 16) | 1U; // increment request and response count each by 1
         break;
     }
-    case ID_DAP_Vendor9:  break;
-    case ID_DAP_Vendor10: break;
+    case ID_DAP_Vendor9:
+#if (DAP_PROFILE != 0)
+      num += DAP_ProfileStatus(response);
+#endif
+      break;
+    case ID_DAP_Vendor10:
+#if (DAP_PROFILE != 0)
+      num += DAP_ProfileReset(response);
+#endif
+      break;
     case ID_DAP_Vendor11: break;
     case ID_DAP_Vendor12: break;
     case ID_DAP_Vendor13: break;
@@ -67,6 +67,53 @@
   PIN_TCK_SET();                        \
   PIN_DELAY()
 
+// Eight cycles shifting a byte LSB first, without loop overhead
+#define JTAG_CYCLE_TDI_BYTE(tdi)        \
+  JTAG_CYCLE_TDI((tdi) >> 0);           \
+  JTAG_CYCLE_TDI((tdi) >> 1);           \
+  JTAG_CYCLE_TDI((tdi) >> 2);           \
+  JTAG_CYCLE_TDI((tdi) >> 3);           \
+  JTAG_CYCLE_TDI((tdi) >> 4);           \
+  JTAG_CYCLE_TDI((tdi) >> 5);           \
+  JTAG_CYCLE_TDI((tdi) >> 6);           \
+  JTAG_CYCLE_TDI((tdi) >> 7)
+
+#define JTAG_CYCLE_TDO_BYTE(tdo,bit)    \
+  JTAG_CYCLE_TDO(bit);                  \
+  tdo  = (bit) << 0;                    \
+  JTAG_CYCLE_TDO(bit);                  \
+  tdo |= (bit) << 1;                    \
+  JTAG_CYCLE_TDO(bit);                  \
+  tdo |= (bit) << 2;                    \
+  JTAG_CYCLE_TDO(bit);                  \
+  tdo |= (bit) << 3;                    \
+  JTAG_CYCLE_TDO(bit);                  \
+  tdo |= (bit) << 4;                    \
+  JTAG_CYCLE_TDO(bit);                  \
+  tdo |= (bit) << 5;                    \
+  JTAG_CYCLE_TDO(bit);                  \
+  tdo |= (bit) << 6;                    \
+  JTAG_CYCLE_TDO(bit);                  \
+  tdo |= (bit) << 7
+
+#define JTAG_CYCLE_TDIO_BYTE(tdi,tdo,bit) \
+  JTAG_CYCLE_TDIO((tdi) >> 0, bit);     \
+  tdo  = (bit) << 0;                    \
+  JTAG_CYCLE_TDIO((tdi) >> 1, bit);     \
+  tdo |= (bit) << 1;                    \
+  JTAG_CYCLE_TDIO((tdi) >> 2, bit);     \
+  tdo |= (bit) << 2;                    \
+  JTAG_CYCLE_TDIO((tdi) >> 3, bit);     \
+  tdo |= (bit) << 3;                    \
+  JTAG_CYCLE_TDIO((tdi) >> 4, bit);     \
+  tdo |= (bit) << 4;                    \
+  JTAG_CYCLE_TDIO((tdi) >> 5, bit);     \
+  tdo |= (bit) << 5;                    \
+  JTAG_CYCLE_TDIO((tdi) >> 6, bit);     \
+  tdo |= (bit) << 6;                    \
+  JTAG_CYCLE_TDIO((tdi) >> 7, bit);     \
+  tdo |= (bit) << 7
+
 #define PIN_DELAY() PIN_DELAY_SLOW(DAP_Data.clock_delay)
 
 
@@ -78,35 +125,43 @@
 //   tdi:    pointer to TDI generated data
 //   tdo:    pointer to TDO captured data
 //   return: none
-void JTAG_Sequence (uint32_t info, const uint8_t *tdi, uint8_t *tdo) {
-  uint32_t i_val;
-  uint32_t o_val;
-  uint32_t bit;
-  uint32_t n, k;
-
-  n = info & JTAG_SEQUENCE_TCK;
-  if (n == 0U) { n = 64U; }
-
-  if (info & JTAG_SEQUENCE_TMS) {
-    PIN_TMS_SET();
-  } else {
-    PIN_TMS_CLR();
-  }
-
-  while (n) {
-    i_val = *tdi++;
-    o_val = 0U;
-    for (k = 8U; k && n; k--, n--) {
-      JTAG_CYCLE_TDIO(i_val, bit);
-      i_val >>= 1;
-      o_val >>= 1;
-      o_val  |= bit << 7;
-    }
-    o_val >>= k;
-    if (info & JTAG_SEQUENCE_TDO) {
-      *tdo++ = (uint8_t)o_val;
-    }
-  }
+#define JTAG_SequenceFunction(speed)        /**/                                \
+void JTAG_Sequence##speed (uint32_t info, const uint8_t *tdi, uint8_t *tdo) {   \
+  uint32_t i_val;                                                               \
+  uint32_t o_val;                                                               \
+  uint32_t bit;                                                                 \
+  uint32_t n, k;                                                                \
+                                                                                \
+  n = info & JTAG_SEQUENCE_TCK;                                                 \
+  if (n == 0U) { n = 64U; }                                                     \
+                                                                                \
+  if (info & JTAG_SEQUENCE_TMS) {                                               \
+    PIN_TMS_SET();                                                              \
+  } else {                                                                      \
+    PIN_TMS_CLR();                                                              \
+  }                                                                             \
+                                                                                \
+  /* Whole bytes are shifted without loop overhead */                           \
+  for (; n >= 8U; n -= 8U) {                                                    \
+    i_val = *tdi++;                                                             \
+    JTAG_CYCLE_TDIO_BYTE(i_val, o_val, bit);                                    \
+    if (info & JTAG_SEQUENCE_TDO) {                                             \
+      *tdo++ = (uint8_t)o_val;                                                  \
+    }                                                                           \
+  }                                                                             \
+                                                                                \
+  /* Remaining bits of the last byte */                                         \
+  if (n) {                                                                      \
+    i_val = *tdi;                                                               \
+    o_val = 0U;                                                                 \
+    for (k = 0U; k < n; k++) {                                                  \
+      JTAG_CYCLE_TDIO(i_val >> k, bit);                                         \
+      o_val |= bit << k;                                                        \
+    }                                                                           \
+    if (info & JTAG_SEQUENCE_TDO) {                                             \
+      *tdo = (uint8_t)o_val;                                                    \
+    }                                                                           \
+  }                                                                             \
 }
 
 
@@ -128,8 +183,13 @@ void JTAG_IR_##speed (uint32_t ir) {
   for (n = DAP_Data.jtag_dev.ir_before[DAP_Data.jtag_dev.index]; n; n--) {      \
     JTAG_CYCLE_TCK();                       /* Bypass before data */            \
   }                                                                             \
-  for (n = DAP_Data.jtag_dev.ir_length[DAP_Data.jtag_dev.index] - 1U; n; n--) { \
-    JTAG_CYCLE_TDI(ir);                     /* Set IR bits (except last) */     \
+  n = DAP_Data.jtag_dev.ir_length[DAP_Data.jtag_dev.index] - 1U;                \
+  for (; n >= 8U; n -= 8U) {                                                    \
+    JTAG_CYCLE_TDI_BYTE(ir);                /* Set IR bits (except last) */     \
+    ir >>= 8;                                                                   \
+  }                                                                             \
+  for (; n; n--) {                                                              \
+    JTAG_CYCLE_TDI(ir);                                                         \
     ir >>= 1;                                                                   \
   }                                                                             \
   n = DAP_Data.jtag_dev.ir_after[DAP_Data.jtag_dev.index];                      \
@@ -161,6 +221,7 @@ void JTAG_IR_##speed (uint32_t ir) {
 uint8_t JTAG_Transfer##speed (uint32_t request, uint32_t *data) {               \
   uint32_t ack;                                                                 \
   uint32_t bit;                                                                 \
+  uint32_t byte;                                                                \
   uint32_t val;                                                                 \
   uint32_t n;                                                                   \
                                                                                 \
@@ -191,10 +252,13 @@ uint8_t JTAG_Transfer##speed (uint32_t request, uint32_t *data) {
   if (request & DAP_TRANSFER_RnW) {                                             \
     /* Read Transfer */                                                         \
     val = 0U;                                                                   \
-    for (n = 31U; n; n--) {                                                     \
-      JTAG_CYCLE_TDO(bit);                  /* Get D0..D30 */                   \
-      val  |= bit << 31;                                                        \
-      val >>= 1;                                                                \
+    for (n = 0U; n < 24U; n += 8U) {                                            \
+      JTAG_CYCLE_TDO_BYTE(byte, bit);       /* Get D0..D23 */                   \
+      val |= byte << n;                                                         \
+    }                                                                           \
+    for (; n < 31U; n++) {                                                      \
+      JTAG_CYCLE_TDO(bit);                  /* Get D24..D30 */                  \
+      val |= bit << n;                                                          \
     }                                                                           \
     n = DAP_Data.jtag_dev.count - DAP_Data.jtag_dev.index - 1U;                 \
     if (n) {                                                                    \
@@ -213,8 +277,12 @@ uint8_t JTAG_Transfer##speed (uint32_t request, uint32_t *data) {
   } else {                                                                      \
     /* Write Transfer */                                                        \
     val = *data;                                                                \
-    for (n = 31U; n; n--) {                                                     \
-      JTAG_CYCLE_TDI(val);                  /* Set D0..D30 */                   \
+    for (n = 3U; n; n--) {                                                      \
+      JTAG_CYCLE_TDI_BYTE(val);             /* Set D0..D23 */                   \
+      val >>= 8;                                                                \
+    }                                                                           \
+    for (n = 7U; n; n--) {                                                      \
+      JTAG_CYCLE_TDI(val);                  /* Set D24..D30 */                  \
       val >>= 1;                                                                \
     }                                                                           \
     n = DAP_Data.jtag_dev.count - DAP_Data.jtag_dev.index - 1u;                 \
@@ -249,11 +317,13 @@ exit:
 
 #undef  PIN_DELAY
 #define PIN_DELAY() PIN_DELAY_FAST()
+JTAG_SequenceFunction(Fast);
 JTAG_IR_Function(Fast);
 JTAG_TransferFunction(Fast);
 
 #undef  PIN_DELAY
 #define PIN_DELAY() PIN_DELAY_SLOW(DAP_Data.clock_delay)
+JTAG_SequenceFunction(Slow);
 JTAG_IR_Function(Slow);
 JTAG_TransferFunction(Slow);
 
@@ -338,6 +408,20 @@ void JTAG_WriteAbort (uint32_t data) {
 }
 
 
+// Generate JTAG Sequence
+//   info:   sequence information
+//   tdi:    pointer to TDI generated data
+//   tdo:    pointer to TDO captured data
+//   return: none
+void JTAG_Sequence (uint32_t info, const uint8_t *tdi, uint8_t *tdo) {
+  if (DAP_Data.fast_clock) {
+    JTAG_SequenceFast(info, tdi, tdo);
+  } else {
+    JTAG_SequenceSlow(info, tdi, tdo);
+  }
+}
+
+
 // JTAG Set IR
 //   ir:     IR value
 //   return: none
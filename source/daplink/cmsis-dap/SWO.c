@@ -28,22 +28,16 @@
 #include "DAP_config.h"
 #include "DAP.h"
 #if (SWO_UART != 0)
-#include "Driver_USART.h"
+#include "uart_swo.h"
+#endif
+#if (SWO_STREAM != 0)
+#include "main.h"
 #endif
 
 
 #if (SWO_UART != 0)
 
-#ifndef  SWO_USART_PORT
-#define  SWO_USART_PORT 0           /* USART Port Number */
-#endif
-
-// USART Driver
-#define _USART_Driver_(n)  Driver_USART##n
-#define  USART_Driver_(n) _USART_Driver_(n)
-extern ARM_DRIVER_USART    USART_Driver_(SWO_USART_PORT);
-#define pUSART           (&USART_Driver_(SWO_USART_PORT))
-
+// SWO capture UART is provided by the HIC (see uart_swo.h)
 static uint8_t  USART_Ready;
 
 #endif  /* (SWO_UART != 0) */
@@ -65,6 +59,17 @@ static volatile uint32_t TraceIn      = 0U; /* Incoming Trace Index */
 static volatile uint32_t TraceOut     = 0U; /* Outgoing Trace Index */
 static volatile uint32_t TracePending = 0U; /* Pending Trace Count */
 
+#if (SWO_STREAM != 0)
+
+// Trace Streaming (Transport 2): TraceBuf is sent in place in blocks of up to
+// SWO_STREAM_BLOCK_SIZE bytes. TraceOut is advanced when a block completes.
+#define SWO_STREAM_BLOCK_SIZE   512U
+
+static volatile uint8_t  TransferBusy = 0U; /* Transfer Busy Flag */
+static          uint32_t TransferSize = 0U; /* Current Transfer Size */
+
+#endif  /* (SWO_STREAM != 0) */
+
 // Trace Helper functions
 static void     ClearTrace     (void);
 static uint32_t GetTraceSpace  (void);
@@ -75,51 +80,46 @@ static void     SetTraceError  (uint8_t flag);
 
 #if (SWO_UART != 0)
 
-// USART Driver Callback function
+// SWO UART Callback function (called from interrupt context)
 //   event: event mask
 static void USART_Callback (uint32_t event) {
   uint32_t count;
 
-  if (event &  ARM_USART_EVENT_RECEIVE_COMPLETE) {
+  if (event & UART_SWO_EVENT_RECEIVE_COMPLETE) {
     TracePending = 0U;
-    TraceIn += pUSART->GetRxCount();
+    TraceIn += uart_swo_get_rx_count();
     count = GetTraceSpace();
     if (count != 0U) {
-      pUSART->Receive(&TraceBuf[TraceIn & (SWO_BUFFER_SIZE-1U)], count);
+      uart_swo_receive(&TraceBuf[TraceIn & (SWO_BUFFER_SIZE-1U)], count);
     } else {
       TraceStatus = DAP_SWO_CAPTURE_ACTIVE | DAP_SWO_CAPTURE_PAUSED;
     }
   }
-  if (event &  ARM_USART_EVENT_RX_OVERFLOW) {
+  if (event & UART_SWO_EVENT_RX_OVERFLOW) {
     SetTraceError(DAP_SWO_BUFFER_OVERRUN);
   }
-  if (event & (ARM_USART_EVENT_RX_BREAK         |
-               ARM_USART_EVENT_RX_FRAMING_ERROR |
-               ARM_USART_EVENT_RX_PARITY_ERROR)) {
+  if (event & UART_SWO_EVENT_RX_ERROR) {
     SetTraceError(DAP_SWO_STREAM_ERROR);
   }
+#if (SWO_STREAM != 0)
+  if ((event & UART_SWO_EVENT_RECEIVE_COMPLETE) && (TraceTransport == 2U)) {
+    main_swo_send_event();
+  }
+#endif
 }
 
 // Enable or disable UART SWO Mode
 //   enable: enable flag
 //   return: 1 - Success, 0 - Error
 __weak uint32_t UART_SWO_Mode (uint32_t enable) {
-  int32_t status;
 
   USART_Ready = 0U;
 
   if (enable) {
-    status = pUSART->Initialize(USART_Callback);
-    if (status != ARM_DRIVER_OK) { return (0U); }
-    status = pUSART->PowerControl(ARM_POWER_FULL);
-    if (status != ARM_DRIVER_OK) {
-      pUSART->Uninitialize();
-      return (0U);
-    }
+    if (!uart_swo_initialize(USART_Callback)) { return (0U); }
   } else {
-    pUSART->Control(ARM_USART_ABORT_RECEIVE, 0U);
-    pUSART->PowerControl(ARM_POWER_OFF);
-    pUSART->Uninitialize();
+    uart_swo_abort_receive();
+    uart_swo_uninitialize();
   }
   return (1U);
 }
@@ -128,7 +128,6 @@ __weak uint32_t UART_SWO_Mode (uint32_t enable) {
 //   baudrate: requested baudrate
 //   return:   actual baudrate or 0 when not configured
 __weak uint32_t UART_SWO_Baudrate (uint32_t baudrate) {
-  int32_t  status;
   uint32_t count;
 
   if (baudrate > SWO_UART_MAX_BAUDRATE) {
@@ -136,32 +135,27 @@ __weak uint32_t UART_SWO_Baudrate (uint32_t baudrate) {
   }
 
   if (TraceStatus & DAP_SWO_CAPTURE_ACTIVE) {
-    pUSART->Control(ARM_USART_CONTROL_RX, 0U);
-    if (pUSART->GetStatus().rx_busy) {
+    uart_swo_enable(false);
+    if (uart_swo_rx_busy()) {
       TracePending = 0U;
-      TraceIn += pUSART->GetRxCount();
-      pUSART->Control(ARM_USART_ABORT_RECEIVE, 0U);
+      TraceIn += uart_swo_abort_receive();
     }
   }
 
-  status = pUSART->Control(ARM_USART_MODE_ASYNCHRONOUS |
-                           ARM_USART_DATA_BITS_8       |
-                           ARM_USART_PARITY_NONE       |
-                           ARM_USART_STOP_BITS_1,
-                           baudrate);
+  // 8 data bits, no parity, 1 stop bit; returns the actual baudrate
+  baudrate = uart_swo_set_baudrate(baudrate);
 
-  if (status == ARM_DRIVER_OK) {
+  if (baudrate != 0U) {
     USART_Ready = 1U;
   } else {
     USART_Ready = 0U;
-    baudrate = 0U;
   }
 
   if ((TraceStatus & DAP_SWO_CAPTURE_ACTIVE) && USART_Ready) {
-    pUSART->Control(ARM_USART_CONTROL_RX, 1U);
+    uart_swo_enable(true);
     count = GetTraceSpace();
     if (count != 0U) {
-      pUSART->Receive(&TraceBuf[TraceIn & (SWO_BUFFER_SIZE-1U)], count);
+      uart_swo_receive(&TraceBuf[TraceIn & (SWO_BUFFER_SIZE-1U)], count);
     } else {
       TraceStatus = DAP_SWO_CAPTURE_ACTIVE | DAP_SWO_CAPTURE_PAUSED;
     }
@@ -174,20 +168,16 @@ __weak uint32_t UART_SWO_Baudrate (uint32_t baudrate) {
 //   active: active flag
 //   return: 1 - Success, 0 - Error
 __weak uint32_t UART_SWO_Control (uint32_t active) {
-  int32_t status;
 
   if (active) {
     if (!USART_Ready) { return (0U); }
-    status = pUSART->Control(ARM_USART_CONTROL_RX, 1U);
-    if (status != ARM_DRIVER_OK) { return (0U); }
-    status = pUSART->Receive(TraceBuf, SWO_BUFFER_SIZE);
-    if (status != ARM_DRIVER_OK) { return (0U); }
+    if (!uart_swo_enable(true)) { return (0U); }
+    if (!uart_swo_receive(TraceBuf, SWO_BUFFER_SIZE)) { return (0U); }
   } else {
-    pUSART->Control(ARM_USART_CONTROL_RX, 0U);
-    if (pUSART->GetStatus().rx_busy) {
+    uart_swo_enable(false);
+    if (uart_swo_rx_busy()) {
       TracePending = 0U;
-      TraceIn += pUSART->GetRxCount();
-      pUSART->Control(ARM_USART_ABORT_RECEIVE, 0U);
+      TraceIn += uart_swo_abort_receive();
     }
   }
   return (1U);
@@ -197,12 +187,12 @@ __weak uint32_t UART_SWO_Control (uint32_t active) {
 //   buf:   pointer to buffer for capturing
 //   count: number of bytes to capture
 __weak void UART_SWO_Capture (uint8_t *buf, uint32_t count) {
-  pUSART->Receive(buf, count);
+  uart_swo_receive(buf, count);
 }
 
 // Update UART SWO Trace Info
 __weak void UART_SWO_Update (void) {
-  TracePending = pUSART->GetRxCount();
+  TracePending = uart_swo_get_rx_count();
 }
 
 #endif  /* (SWO_UART != 0) */
@@ -246,6 +236,12 @@ __weak void Manchester_SWO_Update (void) {
 
 // Clear Trace Errors and Data
 static void ClearTrace (void) {
+#if (SWO_STREAM != 0)
+  if (TransferBusy) {
+    SWO_AbortTransfer();
+    TransferBusy = 0U;
+  }
+#endif
   TraceError[0] = 0U;
   TraceError[1] = 0U;
   TraceError_n  = 0U;
@@ -323,6 +319,9 @@ uint32_t SWO_Transport (const uint8_t *request, uint8_t *response) {
     switch (transport) {
       case 0:
       case 1:
+#if (SWO_STREAM != 0)
+      case 2:
+#endif
         TraceTransport = transport;
         result = 1U;
         break;
@@ -605,4 +604,98 @@ uint32_t SWO_Data (const uint8_t *request, uint8_t *response) {
 }
 
 
+#if (SWO_STREAM != 0)
+
+// Resume paused Trace Capture once space is available again
+static void ResumeTrace (void) {
+  uint32_t n;
+
+  if (TraceStatus == (DAP_SWO_CAPTURE_ACTIVE | DAP_SWO_CAPTURE_PAUSED)) {
+    n = GetTraceSpace();
+    if (n != 0U) {
+      switch (TraceMode) {
+#if (SWO_UART != 0)
+        case DAP_SWO_UART:
+          UART_SWO_Capture(&TraceBuf[TraceIn & (SWO_BUFFER_SIZE-1U)], n);
+          TraceStatus = DAP_SWO_CAPTURE_ACTIVE;
+          break;
+#endif
+#if (SWO_MANCHESTER != 0)
+        case DAP_SWO_MANCHESTER:
+          Manchester_SWO_Capture(&TraceBuf[TraceIn & (SWO_BUFFER_SIZE-1U)], n);
+          TraceStatus = DAP_SWO_CAPTURE_ACTIVE;
+          break;
+#endif
+        default:
+          break;
+      }
+    }
+  }
+}
+
+// Update Trace Info of the active capture mode
+static void UpdateTrace (void) {
+  if (TraceStatus == DAP_SWO_CAPTURE_ACTIVE) {
+    switch (TraceMode) {
+#if (SWO_UART != 0)
+      case DAP_SWO_UART:
+        UART_SWO_Update();
+        break;
+#endif
+#if (SWO_MANCHESTER != 0)
+      case DAP_SWO_MANCHESTER:
+        Manchester_SWO_Update();
+        break;
+#endif
+      default:
+        break;
+    }
+  }
+}
+
+// SWO Streaming Trace transfer completed (called from thread context)
+void SWO_TransferComplete (void) {
+  TraceOut    += TransferSize;
+  TransferBusy = 0U;
+  ResumeTrace();
+  SWO_Process();
+}
+
+// Process SWO Streaming Trace (called from thread context)
+//   starts the next transfer when Transport 2 is selected and data is available
+void SWO_Process (void) {
+  uint32_t index;
+  uint32_t limit;
+  uint32_t count;
+
+  if ((TraceTransport != 2U) || TransferBusy) {
+    return;
+  }
+
+  UpdateTrace();
+
+  count = GetTraceCount();
+  if (count == 0U) {
+    return;
+  }
+
+  index = TraceOut & (SWO_BUFFER_SIZE-1U);
+  limit = SWO_BUFFER_SIZE - index;
+  if (count > limit) {
+    count = limit;
+  }
+  if (count > SWO_STREAM_BLOCK_SIZE) {
+    count = SWO_STREAM_BLOCK_SIZE;
+  }
+
+  TransferSize = count;
+  TransferBusy = 1U;
+  if (!SWO_QueueTransfer(&TraceBuf[index], count)) {
+    TransferBusy = 0U;
+  }
+}
+
+#endif  /* (SWO_STREAM != 0) */
+
+
 #endif  /* ((SWO_UART != 0) || (SWO_MANCHESTER != 0)) */
@@ -30,6 +30,7 @@
 
 #include "DAP_config.h"
 #include "DAP.h"
+#include "dap_profile.h"
 
 
 // SW Macros
@@ -234,11 +235,23 @@ SWD_TransferFunction(Slow);
 //   data:    DATA[31:0]
 //   return:  ACK[2:0]
 uint8_t  SWD_Transfer(uint32_t request, uint32_t *data) {
+#if (DAP_PROFILE != 0)
+  uint8_t ack;
+
+  if (DAP_Data.fast_clock) {
+    ack = SWD_TransferFast(request, data);
+  } else {
+    ack = SWD_TransferSlow(request, data);
+  }
+  dap_profile_swd_ack(ack);
+  return ack;
+#else
   if (DAP_Data.fast_clock) {
     return SWD_TransferFast(request, data);
   } else {
     return SWD_TransferSlow(request, data);
   }
+#endif
 }
 
 
@@ -0,0 +1,213 @@
+/**
+ * @file    dap_profile.c
+ * @brief   Optional execution profiling of the CMSIS-DAP command path
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "string.h"
+#include "RTL.h"
+#include "DAP_config.h"
+#include "DAP.h"
+#include "dap_profile.h"
+#include "util.h"
+
+#if (DAP_PROFILE != 0)
+
+// Standard commands 0x00-0x1F and vendor commands 0x80-0x9F are profiled
+#define STANDARD_COUNT  32
+#define VENDOR_COUNT    32
+#define CMD_COUNT       (STANDARD_COUNT + VENDOR_COUNT)
+
+// Longest line of the text summary
+#define TEXT_LINE_MAX   48
+
+extern uint32_t SystemCoreClock;
+extern U32 os_time;
+
+static dap_profile_cmd_t cmd_table[CMD_COUNT];
+static dap_profile_stats_t stats;
+
+// Written by the USB receive path
+static volatile uint32_t requests_queued;
+// Written by hid_process
+static volatile uint32_t requests_processed;
+// Written with the HID lock held
+static volatile uint32_t responses_sent;
+
+static int32_t get_index(uint8_t id)
+{
+    if (id < STANDARD_COUNT) {
+        return id;
+    }
+
+    if ((id >= ID_DAP_Vendor0) && (id <= ID_DAP_Vendor31)) {
+        return STANDARD_COUNT + (id - ID_DAP_Vendor0);
+    }
+
+    return -1;
+}
+
+void dap_profile_reset(void)
+{
+#if (__CORTEX_M >= 3)
+    // Free running cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    memset(cmd_table, 0, sizeof(cmd_table));
+    memset(&stats, 0, sizeof(stats));
+}
+
+uint32_t dap_profile_time(void)
+{
+#if (__CORTEX_M >= 3)
+    return DWT->CYCCNT;
+#else
+    // No cycle counter, extend the RTX system tick with the SysTick count.
+    // SysTick counts down from LOAD and os_time advances on every reload.
+    uint32_t ticks;
+    uint32_t val;
+
+    do {
+        ticks = os_time;
+        val = SysTick->VAL;
+    } while (ticks != os_time);
+
+    return ticks * (SysTick->LOAD + 1) + (SysTick->LOAD - val);
+#endif
+}
+
+uint32_t dap_profile_clock(void)
+{
+    return SystemCoreClock;
+}
+
+void dap_profile_command(uint8_t id, uint32_t time)
+{
+    int32_t index = get_index(id);
+    dap_profile_cmd_t *cmd;
+
+    if (index < 0) {
+        return;
+    }
+
+    cmd = &cmd_table[index];
+    cmd->calls++;
+    cmd->total += time;
+    if (time > cmd->max) {
+        cmd->max = time;
+    }
+}
+
+void dap_profile_swd_ack(uint32_t ack)
+{
+    if (ack == DAP_TRANSFER_WAIT) {
+        stats.swd_wait++;
+    } else if (ack == DAP_TRANSFER_FAULT) {
+        stats.swd_fault++;
+    }
+}
+
+void dap_profile_request_queued(void)
+{
+    uint32_t depth;
+
+    requests_queued++;
+    depth = requests_queued - requests_processed;
+    if (depth > stats.request_hwm) {
+        stats.request_hwm = depth;
+    }
+}
+
+void dap_profile_request_processed(void)
+{
+    uint32_t depth;
+
+    requests_processed++;
+    depth = requests_processed - responses_sent;
+    if (depth > stats.response_hwm) {
+        stats.response_hwm = depth;
+    }
+}
+
+void dap_profile_response_sent(void)
+{
+    responses_sent++;
+}
+
+const dap_profile_cmd_t *dap_profile_get_command(uint8_t id)
+{
+    int32_t index = get_index(id);
+
+    if (index < 0) {
+        return 0;
+    }
+
+    return &cmd_table[index];
+}
+
+const dap_profile_stats_t *dap_profile_get_stats(void)
+{
+    return &stats;
+}
+
+uint32_t dap_profile_write_text(char *buf, uint32_t size)
+{
+    uint32_t pos;
+    uint32_t i;
+    uint8_t id;
+
+    pos = 0;
+    pos += util_write_string(buf + pos, "# DAP profile, times in ticks of ");
+    pos += util_write_uint32(buf + pos, dap_profile_clock());
+    pos += util_write_string(buf + pos, " Hz\r\n");
+    pos += util_write_string(buf + pos, "SWD WAIT: ");
+    pos += util_write_uint32(buf + pos, stats.swd_wait);
+    pos += util_write_string(buf + pos, "\r\nSWD FAULT: ");
+    pos += util_write_uint32(buf + pos, stats.swd_fault);
+    pos += util_write_string(buf + pos, "\r\nRequest queue max: ");
+    pos += util_write_uint32(buf + pos, stats.request_hwm);
+    pos += util_write_string(buf + pos, "\r\nResponse queue max: ");
+    pos += util_write_uint32(buf + pos, stats.response_hwm);
+    pos += util_write_string(buf + pos, "\r\nID calls total max\r\n");
+
+    for (i = 0; i < CMD_COUNT; i++) {
+        if (cmd_table[i].calls == 0) {
+            continue;
+        }
+
+        if (pos + TEXT_LINE_MAX > size) {
+            break;
+        }
+
+        id = (i < STANDARD_COUNT) ? i : ID_DAP_Vendor0 + (i - STANDARD_COUNT);
+        pos += util_write_hex8(buf + pos, id);
+        pos += util_write_string(buf + pos, " ");
+        pos += util_write_uint32(buf + pos, cmd_table[i].calls);
+        pos += util_write_string(buf + pos, " ");
+        pos += util_write_uint32(buf + pos, cmd_table[i].total);
+        pos += util_write_string(buf + pos, " ");
+        pos += util_write_uint32(buf + pos, cmd_table[i].max);
+        pos += util_write_string(buf + pos, "\r\n");
+    }
+
+    return pos;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file    dap_profile.h
+ * @brief   Optional execution profiling of the CMSIS-DAP command path
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DAP_PROFILE_H
+#define DAP_PROFILE_H
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Profiling is compiled in only when DAP_PROFILE is set to 1 in the project macros
+#ifndef DAP_PROFILE
+#define DAP_PROFILE 0
+#endif
+
+#if (DAP_PROFILE != 0)
+
+typedef struct {
+    uint32_t calls;         // Number of times the command was executed
+    uint32_t total;         // Cumulative execution time in dap_profile_clock() ticks
+    uint32_t max;           // Longest single execution
+} dap_profile_cmd_t;
+
+typedef struct {
+    uint32_t swd_wait;      // SWD transfers answered with ACK WAIT
+    uint32_t swd_fault;     // SWD transfers answered with ACK FAULT
+    uint32_t request_hwm;   // Most requests waiting for the DAP task at once
+    uint32_t response_hwm;  // Most responses waiting for USB at once
+} dap_profile_stats_t;
+
+void dap_profile_reset(void);
+uint32_t dap_profile_time(void);
+uint32_t dap_profile_clock(void);
+
+// Hooks for the command path
+void dap_profile_command(uint8_t id, uint32_t time);
+void dap_profile_swd_ack(uint32_t ack);
+void dap_profile_request_queued(void);
+void dap_profile_request_processed(void);
+void dap_profile_response_sent(void);
+
+// Returns 0 if the command ID is not profiled
+const dap_profile_cmd_t *dap_profile_get_command(uint8_t id);
+const dap_profile_stats_t *dap_profile_get_stats(void);
+
+// Write a text summary into buf, returns the number of characters written
+uint32_t dap_profile_write_text(char *buf, uint32_t size);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * @file    usbd_user_bulk.c
+ * @brief   SWO trace streaming over the USB vendor bulk interface
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RTL.h"
+#include "rl_usb.h"
+#include "DAP_config.h"
+#include "DAP.h"
+
+#if (SWO_STREAM != 0)
+
+// Start sending a block of the trace buffer
+//   return: 1 - transfer queued, 0 - endpoint busy or device not configured
+uint32_t SWO_QueueTransfer(uint8_t *buf, uint32_t num)
+{
+    return USBD_BULK_SWO_DataSend(buf, num) != 0 ? 1 : 0;
+}
+
+// Drop the block being sent
+void SWO_AbortTransfer(void)
+{
+    USBD_BULK_SWO_Abort();
+}
+
+// Called from the bulk class when the block has been sent
+void usbd_bulk_swo_complete(void)
+{
+    SWO_TransferComplete();
+}
+
+// Called by the main task on a SWO event or on the 30mS tick
+void swo_process_event(void)
+{
+    SWO_Process();
+}
+
+#endif
@@ -28,6 +28,8 @@
 #include "DAP_config.h"
 #include "DAP.h"
 #include "util.h"
+#include "dap_profile.h"
+#include "cortex_m.h"
 
 #include "main.h"
 
@@ -37,25 +39,54 @@
 #if (USBD_HID_INREPORT_MAX_SZ != DAP_PACKET_SIZE)
 #error "USB HID Input Report Size must match DAP Packet Size"
 #endif
+#if (USBD_BULK_ENABLE) && (USBD_BULK_CMD_MAX_SZ != DAP_PACKET_SIZE)
+#error "USB Bulk Command Size must match DAP Packet Size"
+#endif
 
 #define FREE_SEM_INIT_COUNT          (DAP_PACKET_COUNT)
 #define PROC_SEM_INIT_COUNT          0
 #define SEND_SEM_INIT_COUNT          0
 
-static uint8_t temp_buf                      [DAP_PACKET_SIZE];
-static uint8_t USB_Request [DAP_PACKET_COUNT][DAP_PACKET_SIZE];  // Request  Buffer
+#define DAP_TRANSPORT_HID            0
+#define DAP_TRANSPORT_BULK           1
+
+// The host can keep DAP_PACKET_COUNT commands queued and the ring has one slot
+// more. The response to the request in a slot is written to the slot before
+// it, which held the previous request and is free once that has executed, so
+// responses are never copied. A slot is released once its response is sent.
+#define DAP_SLOT_COUNT               (DAP_PACKET_COUNT + 1)
+#define RESPONSE_SLOT(idx)           (((idx) + DAP_PACKET_COUNT) % DAP_SLOT_COUNT)
+
+// Word aligned, so the read data of a TransferBlock that starts a packet
+// is stored a word at a time
+__attribute__((aligned(4)))
+static uint8_t USB_Packet[DAP_SLOT_COUNT][DAP_PACKET_SIZE];  // Request and Response Buffer
+
+#if (USBD_BULK_ENABLE)
+// Commands also arrive on the CMSIS-DAP v2 bulk interface. Each slot remembers
+// its transport so the response goes back the way the request came in.
+static uint8_t  USB_Transport[DAP_SLOT_COUNT];
+static uint16_t USB_ResponseLen[DAP_SLOT_COUNT];
+
+// Set once a free slot has been taken for the next bulk command
+static uint8_t  bulk_slot_taken;
+
+extern void USBD_Intr(int ena);
+#endif
 
 static OS_SEM free_sem;
 static OS_SEM proc_sem;
 static OS_SEM send_sem;
 
 static OS_MUT hid_mutex;
+static OS_MUT dap_mutex;
 
-// Only used by HID out thread
+// Only used by HID and bulk out threads
 static uint32_t recv_idx;
 
 // Only used by hid_process
 static uint32_t proc_idx;
+static uint32_t proc_queued;
 
 // Used by hid_process and HID out thread
 // so must be synchronized to HID lock
@@ -67,12 +98,118 @@ void usbd_hid_init(void)
 {
     recv_idx = 0;
     proc_idx = 0;
+    proc_queued = 0;
     send_idx = 0;
     USB_ResponseIdle = 1;
+#if (USBD_BULK_ENABLE)
+    bulk_slot_taken = 0;
+#endif
     os_sem_init(&free_sem, FREE_SEM_INIT_COUNT);
     os_sem_init(&proc_sem, PROC_SEM_INIT_COUNT);
     os_sem_init(&send_sem, SEND_SEM_INIT_COUNT);
     os_mut_init(&hid_mutex);
+    os_mut_init(&dap_mutex);
+}
+
+// Claim the debug port. hid_process holds the lock while it executes
+// commands, so the holder sees DAP_Data.debug_port as it is between
+// commands and can use the port while the host does not.
+void DAP_Lock(void)
+{
+    os_mut_wait(&dap_mutex, 0xFFFF);
+}
+
+// Release the debug port
+void DAP_Unlock(void)
+{
+    os_mut_release(&dap_mutex);
+}
+
+#if (USBD_BULK_ENABLE)
+// Read the bulk command the host was held off with, now that a slot is
+// free. The bulk class is otherwise only entered from the USB interrupt,
+// so the interrupt is masked while a task does this.
+static void resume_bulk_cmd(void)
+{
+    if (cortex_in_isr()) {
+        USBD_BULK_CMD_Resume();
+    } else {
+        USBD_Intr(0);
+        USBD_BULK_CMD_Resume();
+        USBD_Intr(1);
+    }
+}
+#endif
+
+// Release the slot of the response at send_idx
+// Must be called with hid_mutex held
+static void free_response(void)
+{
+    send_idx = (send_idx + 1) % DAP_SLOT_COUNT;
+#if (DAP_PROFILE != 0)
+    dap_profile_response_sent();
+#endif
+    os_sem_send(&free_sem);
+#if (USBD_BULK_ENABLE)
+    resume_bulk_cmd();
+#endif
+}
+
+// Hand the response at send_idx to the bulk interface if that is where its
+// request came from. Must be called with hid_mutex held and send_sem taken.
+// Returns 1 if nothing is left for HID to send, 0 if the response is for HID.
+static uint32_t send_bulk_response(void)
+{
+#if (USBD_BULK_ENABLE)
+    while (USB_Transport[send_idx] == DAP_TRANSPORT_BULK) {
+        if (USBD_BULK_CMD_DataSend(USB_Packet[RESPONSE_SLOT(send_idx)], USB_ResponseLen[send_idx]) > 0) {
+            // Slot is freed in usbd_bulk_cmd_complete
+            return 1;
+        }
+
+        // Interface not configured anymore, drop the response
+        free_response();
+
+        if (os_sem_wait(&send_sem, 0) != OS_R_OK) {
+            USB_ResponseIdle = 1;
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
+
+// Store a request into the next free packet buffer
+//   slot_taken: the caller already took the free slot from free_sem
+static void queue_request(U8 *buf, int len, uint8_t transport, uint8_t slot_taken)
+{
+    if ((len == 0) || (buf[0] == ID_DAP_TransferAbort)) {
+        if (len != 0) {
+            DAP_TransferAbort = 1;
+        }
+
+        if (slot_taken) {
+            os_sem_send(&free_sem);
+        }
+
+        return;
+    }
+
+    // Store data into request packet buffer
+    // If there are no free buffers discard the data
+    if (slot_taken || (os_sem_wait(&free_sem, 0) == OS_R_OK)) {
+        memcpy(USB_Packet[recv_idx], buf, len);
+#if (USBD_BULK_ENABLE)
+        USB_Transport[recv_idx] = transport;
+#endif
+        recv_idx = (recv_idx + 1) % DAP_SLOT_COUNT;
+#if (DAP_PROFILE != 0)
+        dap_profile_request_queued();
+#endif
+        os_sem_send(&proc_sem);
+    } else {
+        util_assert(0);
+    }
 }
 
 // USB HID Callback: when data needs to be prepared for the host
@@ -89,11 +226,12 @@ int usbd_hid_get_report(U8 rtype, U8 rid, U8 *buf, U8 req)
                     os_mut_wait(&hid_mutex, 0xFFFF);
 
                     if (os_sem_wait(&send_sem, 0) == OS_R_OK) {
-                        memcpy(buf, USB_Request[send_idx], DAP_PACKET_SIZE);
-                        send_idx = (send_idx + 1) % DAP_PACKET_COUNT;
-                        os_sem_send(&free_sem);
-                        os_mut_release(&hid_mutex);
-                        return (DAP_PACKET_SIZE);
+                        if (!send_bulk_response()) {
+                            memcpy(buf, USB_Packet[RESPONSE_SLOT(send_idx)], DAP_PACKET_SIZE);
+                            free_response();
+                            os_mut_release(&hid_mutex);
+                            return (DAP_PACKET_SIZE);
+                        }
                     } else {
                         USB_ResponseIdle = 1;
                     }
@@ -116,25 +254,7 @@ void usbd_hid_set_report(U8 rtype, U8 rid, U8 *buf, int len, U8 req)
 {
     switch (rtype) {
         case HID_REPORT_OUTPUT:
-            if (len == 0) {
-                break;
-            }
-
-            if (buf[0] == ID_DAP_TransferAbort) {
-                DAP_TransferAbort = 1;
-                break;
-            }
-
-            // Store data into request packet buffer
-            // If there are no free buffers discard the data
-            if (os_sem_wait(&free_sem, 0) == OS_R_OK) {
-                memcpy(USB_Request[recv_idx], buf, len);
-                recv_idx = (recv_idx + 1) % DAP_PACKET_COUNT;
-                os_sem_send(&proc_sem);
-            } else {
-                util_assert(0);
-            }
-
+            queue_request(buf, len, DAP_TRANSPORT_HID, 0);
             break;
 
         case HID_REPORT_FEATURE:
@@ -151,23 +271,96 @@ void hid_send_packet(void)
     // There must be data avaiable to send when hid_send_packet is called
     util_assert(OS_R_OK == ret);
 
-    usbd_hid_get_report_trigger(0, USB_Request[send_idx], DAP_PACKET_SIZE);
-    send_idx = (send_idx + 1) % DAP_PACKET_COUNT;
-    os_sem_send(&free_sem);
+    if (!send_bulk_response()) {
+        usbd_hid_get_report_trigger(0, USB_Packet[RESPONSE_SLOT(send_idx)], DAP_PACKET_SIZE);
+        free_response();
+    }
+
+    os_mut_release(&hid_mutex);
+}
+
+#if (USBD_BULK_ENABLE)
+// USB Bulk Callback: before a command packet is read from the endpoint
+// A slot is taken for the command up front. Without one the packet stays
+// in the endpoint and the host is NAKed, the command is read once
+// free_response has released a slot.
+BOOL usbd_bulk_cmd_ready(void)
+{
+    if (!bulk_slot_taken && (os_sem_wait(&free_sem, 0) == OS_R_OK)) {
+        bulk_slot_taken = 1;
+    }
+
+    return bulk_slot_taken ? __TRUE : __FALSE;
+}
+
+// USB Bulk Callback: when a command is received from the host
+void usbd_bulk_cmd_received(U8 *buf, int len)
+{
+    bulk_slot_taken = 0;
+    queue_request(buf, len, DAP_TRANSPORT_BULK, 1);
+}
+
+// USB Bulk Callback: when a response has been sent to the host
+void usbd_bulk_cmd_complete(void)
+{
+    os_mut_wait(&hid_mutex, 0xFFFF);
+    free_response();
+
+    if (os_sem_wait(&send_sem, 0) == OS_R_OK) {
+        if (!send_bulk_response()) {
+            usbd_hid_get_report_trigger(0, USB_Packet[RESPONSE_SLOT(send_idx)], DAP_PACKET_SIZE);
+            free_response();
+        }
+    } else {
+        USB_ResponseIdle = 1;
+    }
 
     os_mut_release(&hid_mutex);
 }
+#endif
 
 // CMSIS-DAP task
 __task void hid_process(void *argv)
 {
+    uint32_t idx;
+    uint32_t cnt;
+    uint32_t len;
+    uint8_t *response;
+
     while (1) {
-        // Process DAP Command
         os_sem_wait(&proc_sem, 0xFFFF);
-        DAP_ExecuteCommand(USB_Request[proc_idx], temp_buf);
-        memcpy(USB_Request[proc_idx], temp_buf, DAP_PACKET_SIZE);
-        proc_idx = (proc_idx + 1) % DAP_PACKET_COUNT;
-        os_sem_send(&send_sem);
+
+        // Hold back QueueCommands packets until one that is not queued
+        // arrives, unless that would leave the host no free buffer
+        idx = (proc_idx + proc_queued) % DAP_SLOT_COUNT;
+        if ((USB_Packet[idx][0] == ID_DAP_QueueCommands) &&
+                (proc_queued + 1 < DAP_PACKET_COUNT)) {
+            proc_queued++;
+            continue;
+        }
+
+        // Process the batch of DAP Commands in order
+        for (cnt = proc_queued + 1; cnt > 0; cnt--) {
+            response = USB_Packet[RESPONSE_SLOT(proc_idx)];
+            DAP_Lock();
+            len = DAP_ExecuteCommand(USB_Packet[proc_idx], response) & 0xFFFF;
+            DAP_Unlock();
+#if (USBD_BULK_ENABLE)
+            USB_ResponseLen[proc_idx] = (uint16_t)len;
+            if (USB_Transport[proc_idx] == DAP_TRANSPORT_HID)
+#endif
+            {
+                // Input reports are a full packet, clear what is left
+                // of the previous request
+                memset(response + len, 0, DAP_PACKET_SIZE - len);
+            }
+            proc_idx = (proc_idx + 1) % DAP_SLOT_COUNT;
+#if (DAP_PROFILE != 0)
+            dap_profile_request_processed();
+#endif
+            os_sem_send(&send_sem);
+        }
+        proc_queued = 0;
 
         // Send input report if USB is idle
         os_mut_wait(&hid_mutex, 0xFFFF);
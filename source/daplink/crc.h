@@ -27,10 +27,44 @@
 extern "C" {
 #endif
 
+/*
+ * CRC32 kernels, selected per HIC with CRC32_ENGINE.  The table
+ * driven kernels trade flash for speed:
+ *   NIBBLE - 64 byte table, two lookups per byte
+ *   SLICE4 - 4KB table, four bytes per step
+ *   SLICE8 - 8KB table, eight bytes per step
+ *   HAL    - CRC peripheral of the HIC through crc32_hal_update()
+ */
+#define CRC32_ENGINE_NIBBLE		0
+#define CRC32_ENGINE_SLICE4		1
+#define CRC32_ENGINE_SLICE8		2
+#define CRC32_ENGINE_HAL		3
+
+#ifndef CRC32_ENGINE
+#define CRC32_ENGINE			CRC32_ENGINE_NIBBLE
+#endif
+
 uint16_t crc16(const void *data, int nBytes);
 uint32_t crc32(const void *data, int nBytes);
 uint32_t crc32_continue(uint32_t prev_crc, const void *data, int nBytes);
 
+/*
+ * Streaming CRC32 of data that arrives in blocks:
+ *   remainder = crc32_init();
+ *   remainder = crc32_update(remainder, block, size);  (for each block)
+ *   crc = crc32_final(remainder);
+ * gives the same CRC as crc32() over all blocks.
+ */
+uint32_t crc32_init(void);
+uint32_t crc32_update(uint32_t remainder, const void *data, int nBytes);
+uint32_t crc32_final(uint32_t remainder);
+
+#if (CRC32_ENGINE == CRC32_ENGINE_HAL)
+// Bring data into a remainder of the reflected CRC-32 (polynomial
+// 0xEDB88320), implemented by HICs with a CRC peripheral
+uint32_t crc32_hal_update(uint32_t remainder, const void *data, int nBytes);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
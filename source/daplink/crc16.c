@@ -22,85 +22,32 @@
 
 #include "crc.h"
 
-#define FALSE	0
-#define TRUE	!FALSE
-
 typedef unsigned short  crc;
 
 #define CRC_NAME			"CRC-16"
 #define POLYNOMIAL			0x8005
 #define INITIAL_REMAINDER	0x0000
 #define FINAL_XOR_VALUE		0x0000
-#define REFLECT_DATA		TRUE
-#define REFLECT_REMAINDER	TRUE
 #define CHECK_VALUE			0xBB3D
 
 /*
- * Derive parameters from the standard-specific parameters in crc.h.
+ * Remainders of the reflected POLYNOMIAL (0xA001) for every 4-bit
+ * value, using the same nibble kernel as crc32.c.
  */
-#define WIDTH    (8 * sizeof(crc))
-#define TOPBIT   (1 << (WIDTH - 1))
-
-#if (REFLECT_DATA == TRUE)
-#undef  REFLECT_DATA
-#define REFLECT_DATA(X)			((unsigned char) reflect((X), 8))
-#else
-#undef  REFLECT_DATA
-#define REFLECT_DATA(X)			(X)
-#endif
-
-#if (REFLECT_REMAINDER == TRUE)
-#undef  REFLECT_REMAINDER
-#define REFLECT_REMAINDER(X)	((crc) reflect((X), WIDTH))
-#else
-#undef  REFLECT_REMAINDER
-#define REFLECT_REMAINDER(X)	(X)
-#endif
-
-
-/*********************************************************************
- *
- * Function:    reflect()
- *
- * Description: Reorder the bits of a binary sequence, by reflecting
- *				them about the middle position.
- *
- * Notes:		No checking is done that nBits <= 32.
- *
- * Returns:		The reflection of the original data.
- *
- *********************************************************************/
-static unsigned long
-reflect(unsigned long data, unsigned char nBits)
-{
-    unsigned long  reflection = 0x00000000;
-    unsigned char  bit;
-
-    /*
-     * Reflect the data about the center bit.
-     */
-    for (bit = 0; bit < nBits; ++bit) {
-        /*
-         * If the LSB bit is set, set the reflection of it.
-         */
-        if (data & 0x01) {
-            reflection |= (1 << ((nBits - 1) - bit));
-        }
-
-        data = (data >> 1);
-    }
-
-    return (reflection);
-}	/* reflect() */
+static const crc crc_table[16] = {
+    0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+    0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400,
+};
 
 
 /*********************************************************************
  *
- * Function:    crcSlow()
+ * Function:    crc16()
  *
  * Description: Compute the CRC of a given message.
  *
- * Notes:
+ * Notes:		Modulo-2 division is done four bits at a time on the
+ *				reflected remainder.
  *
  * Returns:		The CRC of the message.
  *
@@ -110,35 +57,13 @@ crc16(const void *data, int nBytes)
 {
     crc            remainder = INITIAL_REMAINDER;
     int            byte;
-    unsigned char  bit;
     unsigned char const *message = data;
 
-    /*
-     * Perform modulo-2 division, a byte at a time.
-     */
     for (byte = 0; byte < nBytes; ++byte) {
-        /*
-         * Bring the next byte into the remainder.
-         */
-        remainder ^= (REFLECT_DATA(message[byte]) << (WIDTH - 8));
-
-        /*
-         * Perform modulo-2 division, a bit at a time.
-         */
-        for (bit = 8; bit > 0; --bit) {
-            /*
-             * Try to divide the current data bit.
-             */
-            if (remainder & TOPBIT) {
-                remainder = (remainder << 1) ^ POLYNOMIAL;
-            } else {
-                remainder = (remainder << 1);
-            }
-        }
+        remainder ^= message[byte];
+        remainder = (remainder >> 4) ^ crc_table[remainder & 0xF];
+        remainder = (remainder >> 4) ^ crc_table[remainder & 0xF];
     }
 
-    /*
-     * The final remainder is the CRC result.
-     */
-    return (REFLECT_REMAINDER(remainder) ^ FINAL_XOR_VALUE);
-}   /* crcSlow() */
+    return (remainder ^ FINAL_XOR_VALUE);
+}   /* crc16() */
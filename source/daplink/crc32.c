@@ -22,76 +22,164 @@
 
 #include "crc.h"
 
-#define FALSE	0
-#define TRUE	!FALSE
-
 typedef unsigned long  crc;
 
 #define CRC_NAME			"CRC-32"
 #define POLYNOMIAL			0x04C11DB7
 #define INITIAL_REMAINDER	0xFFFFFFFF
 #define FINAL_XOR_VALUE		0xFFFFFFFF
-#define REFLECT_DATA		TRUE
-#define REFLECT_REMAINDER	TRUE
 #define CHECK_VALUE			0xCBF43926
 
 /*
- * Derive parameters from the standard-specific parameters in crc.h.
+ * All kernels work on the reflected remainder.  The reflected
+ * POLYNOMIAL (0xEDB88320) consumes data LSB first, so no per-byte or
+ * final reflection is needed.
  */
-#define WIDTH    (8 * sizeof(crc))
-#define TOPBIT   (1U << (WIDTH - 1))
+#if (CRC32_ENGINE == CRC32_ENGINE_SLICE4)
+#define CRC32_SLICES		4
+#elif (CRC32_ENGINE == CRC32_ENGINE_SLICE8)
+#define CRC32_SLICES		8
+#endif
+
+#ifdef CRC32_SLICES
+#include "crc32_table.h"
 
-#if (REFLECT_DATA == TRUE)
-#undef  REFLECT_DATA
-#define REFLECT_DATA(X)			((unsigned char) reflect((X), 8))
+#define WORD_AT(P)	((crc)(P)[0] | ((crc)(P)[1] << 8) | ((crc)(P)[2] << 16) | ((crc)(P)[3] << 24))
+#define SLICE(K, X)	(crc32_table[(K)][(X) & 0xFF])
 #else
-#undef  REFLECT_DATA
-#define REFLECT_DATA(X)			(X)
+/*
+ * Remainders for every 4-bit value, a nibble table keeps the flash
+ * cost at 64 bytes.
+ */
+static const crc crc_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
 #endif
 
-#if (REFLECT_REMAINDER == TRUE)
-#undef  REFLECT_REMAINDER
-#define REFLECT_REMAINDER(X)	((crc) reflect((X), WIDTH))
-#else
-#undef  REFLECT_REMAINDER
-#define REFLECT_REMAINDER(X)	(X)
+#if (CRC32_ENGINE == CRC32_ENGINE_HAL)
+/*
+ * State of the peripheral self-test.  The CRC of the check string is
+ * computed in one block and split after the first word so the seed
+ * of the second block is not symmetric under bit reversal.  If either
+ * result is wrong the nibble kernel is used instead.
+ */
+#define HAL_UNTESTED		0
+#define HAL_PASSED			1
+#define HAL_FAILED			2
+
+static volatile unsigned char hal_status = HAL_UNTESTED;
+
+static crc crc32_remainder(crc remainder, const void *data, int nBytes);
+
+
+/*********************************************************************
+ *
+ * Function:    crc32_hal_passed()
+ *
+ * Description: Check the CRC peripheral against CHECK_VALUE.
+ *
+ * Notes:		Runs before the peripheral computes its first CRC.  The
+ *				last byte of the check string goes through the
+ *				software loop of crc32_remainder().  Two tasks
+ *				racing here compute the same result.
+ *
+ * Returns:		Non-zero if the peripheral can be used.
+ *
+ *********************************************************************/
+static int
+crc32_hal_passed(void)
+{
+    static const unsigned char check[] = "123456789";
+    crc whole;
+    crc split;
+
+    if (HAL_UNTESTED == hal_status) {
+        whole = crc32_hal_update(INITIAL_REMAINDER, check, 8);
+        split = crc32_hal_update(INITIAL_REMAINDER, check, 4);
+        split = crc32_hal_update(split, check + 4, 4);
+        whole = crc32_remainder(whole, check + 8, 1) ^ FINAL_XOR_VALUE;
+        split = crc32_remainder(split, check + 8, 1) ^ FINAL_XOR_VALUE;
+        hal_status = ((CHECK_VALUE == whole) && (CHECK_VALUE == split)) ?
+                     HAL_PASSED : HAL_FAILED;
+    }
+
+    return (HAL_PASSED == hal_status);
+}	/* crc32_hal_passed() */
 #endif
 
 
 /*********************************************************************
  *
- * Function:    reflect()
+ * Function:    crc32_remainder()
  *
- * Description: Reorder the bits of a binary sequence, by reflecting
- *				them about the middle position.
+ * Description: Bring a message into a reflected remainder.
  *
- * Notes:		No checking is done that nBits <= 32.
+ * Notes:		Words are assembled a byte at a time since the HICs
+ *				do not all support unaligned access.
  *
- * Returns:		The reflection of the original data.
+ * Returns:		The new remainder.
  *
  *********************************************************************/
-static unsigned long
-reflect(unsigned long data, unsigned char nBits)
+static crc
+crc32_remainder(crc remainder, const void *data, int nBytes)
 {
-    unsigned long  reflection = 0x00000000;
-    unsigned char  bit;
+    unsigned char const *message = data;
 
+#if (CRC32_ENGINE == CRC32_ENGINE_SLICE8)
+    /*
+     * Perform modulo-2 division, eight bytes at a time.
+     */
+    while (nBytes >= 8) {
+        crc high = WORD_AT(message + 4);
+        remainder ^= WORD_AT(message);
+        remainder = SLICE(7, remainder) ^ SLICE(6, remainder >> 8) ^
+                    SLICE(5, remainder >> 16) ^ SLICE(4, remainder >> 24) ^
+                    SLICE(3, high) ^ SLICE(2, high >> 8) ^
+                    SLICE(1, high >> 16) ^ SLICE(0, high >> 24);
+        message += 8;
+        nBytes -= 8;
+    }
+#elif (CRC32_ENGINE == CRC32_ENGINE_SLICE4)
     /*
-     * Reflect the data about the center bit.
+     * Perform modulo-2 division, four bytes at a time.
      */
-    for (bit = 0; bit < nBits; ++bit) {
-        /*
-         * If the LSB bit is set, set the reflection of it.
-         */
-        if (data & 0x01) {
-            reflection |= (1 << ((nBits - 1) - bit));
-        }
-
-        data = (data >> 1);
+    while (nBytes >= 4) {
+        remainder ^= WORD_AT(message);
+        remainder = SLICE(3, remainder) ^ SLICE(2, remainder >> 8) ^
+                    SLICE(1, remainder >> 16) ^ SLICE(0, remainder >> 24);
+        message += 4;
+        nBytes -= 4;
     }
+#elif (CRC32_ENGINE == CRC32_ENGINE_HAL)
+    /*
+     * The peripheral handles all the whole words.
+     */
+    if ((nBytes >= 4) && crc32_hal_passed()) {
+        int words = nBytes & ~3;
+        remainder = crc32_hal_update(remainder, message, words);
+        message += words;
+        nBytes -= words;
+    }
+#endif
 
-    return (reflection);
-}	/* reflect() */
+    /*
+     * Perform modulo-2 division on the remaining bytes.
+     */
+    while (nBytes-- > 0) {
+#ifdef CRC32_SLICES
+        remainder = (remainder >> 8) ^ SLICE(0, remainder ^ *message++);
+#else
+        remainder ^= *message++;
+        remainder = (remainder >> 4) ^ crc_table[remainder & 0xF];
+        remainder = (remainder >> 4) ^ crc_table[remainder & 0xF];
+#endif
+    }
+
+    return (remainder);
+}	/* crc32_remainder() */
 
 
 /*********************************************************************
@@ -108,39 +196,7 @@ reflect(unsigned long data, unsigned char nBits)
 uint32_t
 crc32(const void *data, int nBytes)
 {
-    crc            remainder = INITIAL_REMAINDER;
-    int            byte;
-    unsigned char  bit;
-    unsigned char const *message = data;
-
-    /*
-     * Perform modulo-2 division, a byte at a time.
-     */
-    for (byte = 0; byte < nBytes; ++byte) {
-        /*
-         * Bring the next byte into the remainder.
-         */
-        remainder ^= (REFLECT_DATA(message[byte]) << (WIDTH - 8));
-
-        /*
-         * Perform modulo-2 division, a bit at a time.
-         */
-        for (bit = 8; bit > 0; --bit) {
-            /*
-             * Try to divide the current data bit.
-             */
-            if (remainder & TOPBIT) {
-                remainder = (remainder << 1) ^ POLYNOMIAL;
-            } else {
-                remainder = (remainder << 1);
-            }
-        }
-    }
-
-    /*
-     * The final remainder is the CRC result.
-     */
-    return (REFLECT_REMAINDER(remainder) ^ FINAL_XOR_VALUE);
+    return crc32_final(crc32_update(crc32_init(), data, nBytes));
 }   /* crc32() */
 
 /*********************************************************************
@@ -149,7 +205,8 @@ crc32(const void *data, int nBytes)
  *
  * Description: Compute the CRC of a given message.
  *
- * Notes:
+ * Notes:		prev_crc is the CRC of the data before this message,
+ *				or 0 to start a new CRC.
  *
  * Returns:		The CRC of the message.
  *
@@ -157,37 +214,56 @@ crc32(const void *data, int nBytes)
 uint32_t
 crc32_continue(uint32_t prev_crc, const void *data, int nBytes)
 {
-    crc            remainder = REFLECT_REMAINDER(prev_crc ^ FINAL_XOR_VALUE);
-    int            byte;
-    unsigned char  bit;
-    unsigned char const *message = data;
+    return crc32_final(crc32_update(prev_crc ^ FINAL_XOR_VALUE, data, nBytes));
+}   /* crc32_continue() */
 
-    /*
-     * Perform modulo-2 division, a byte at a time.
-     */
-    for (byte = 0; byte < nBytes; ++byte) {
-        /*
-         * Bring the next byte into the remainder.
-         */
-        remainder ^= (REFLECT_DATA(message[byte]) << (WIDTH - 8));
-
-        /*
-         * Perform modulo-2 division, a bit at a time.
-         */
-        for (bit = 8; bit > 0; --bit) {
-            /*
-             * Try to divide the current data bit.
-             */
-            if (remainder & TOPBIT) {
-                remainder = (remainder << 1) ^ POLYNOMIAL;
-            } else {
-                remainder = (remainder << 1);
-            }
-        }
-    }
+/*********************************************************************
+ *
+ * Function:    crc32_init()
+ *
+ * Description: Start a streaming CRC.
+ *
+ * Notes:
+ *
+ * Returns:		The remainder of an empty message.
+ *
+ *********************************************************************/
+uint32_t
+crc32_init(void)
+{
+    return (INITIAL_REMAINDER);
+}   /* crc32_init() */
 
-    /*
-     * The final remainder is the CRC result.
-     */
-    return (REFLECT_REMAINDER(remainder) ^ FINAL_XOR_VALUE);
-}   /* crc32_continue() */
+/*********************************************************************
+ *
+ * Function:    crc32_update()
+ *
+ * Description: Bring the next block of a message into a remainder.
+ *
+ * Notes:
+ *
+ * Returns:		The new remainder.
+ *
+ *********************************************************************/
+uint32_t
+crc32_update(uint32_t remainder, const void *data, int nBytes)
+{
+    return (crc32_remainder(remainder, data, nBytes));
+}   /* crc32_update() */
+
+/*********************************************************************
+ *
+ * Function:    crc32_final()
+ *
+ * Description: Finish a streaming CRC.
+ *
+ * Notes:
+ *
+ * Returns:		The CRC of the message.
+ *
+ *********************************************************************/
+uint32_t
+crc32_final(uint32_t remainder)
+{
+    return (remainder ^ FINAL_XOR_VALUE);
+}   /* crc32_final() */
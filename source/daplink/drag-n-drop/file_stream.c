@@ -56,9 +56,20 @@ typedef struct {
     uint32_t flash_addr;
 } bin_state_t;
 
+// Size of the buffer hex data is decoded into before it is programmed.
+// A larger buffer means fewer, larger writes to the flash decoder.
+#ifndef HEX_BUFFER_SIZE
+#define HEX_BUFFER_SIZE 256
+#endif
+
+// Must hold the largest hex record
+COMPILER_ASSERT(HEX_BUFFER_SIZE >= 255);
+
 typedef struct {
     bool parsing_complete;
-    uint8_t bin_buffer[256];
+    uint32_t bin_address;       // Address of the first byte in bin_buffer
+    uint32_t bin_count;         // Decoded data in bin_buffer waiting to be programmed
+    uint8_t bin_buffer[HEX_BUFFER_SIZE];
 } hex_state_t;
 
 typedef union {
@@ -304,42 +315,45 @@ static error_t open_hex(void *state)
     return status;
 }
 
+// Program the data decoded so far
+static error_t flush_hex(hex_state_t *hex_state)
+{
+    error_t status = ERROR_SUCCESS;
+
+    if (hex_state->bin_count > 0) {
+        status = flash_decoder_write(hex_state->bin_address, hex_state->bin_buffer, hex_state->bin_count);
+        hex_state->bin_count = 0;
+    }
+
+    return status;
+}
+
 static error_t write_hex(void *state, const uint8_t *data, uint32_t size)
 {
     error_t status = ERROR_SUCCESS;
     hex_state_t *hex_state = (hex_state_t *)state;
     hexfile_parse_status_t parse_status = HEX_PARSE_UNINIT;
-    uint32_t bin_start_address = 0; // Decoded from the hex file, the binary buffer data starts at this address
-    uint32_t bin_buf_written = 0;   // The amount of data in the binary buffer starting at address above
     uint32_t block_amt_parsed = 0;  // amount of data parsed in the block on the last call
 
     while (1) {
         // try to decode a block of hex data into bin data
-        parse_status = parse_hex_blob(data, size, &block_amt_parsed, hex_state->bin_buffer, sizeof(hex_state->bin_buffer), &bin_start_address, &bin_buf_written);
+        parse_status = parse_hex_blob(data, size, &block_amt_parsed, hex_state->bin_buffer, sizeof(hex_state->bin_buffer), &hex_state->bin_address, &hex_state->bin_count);
+        // incrememntal offset to finish the block
+        size -= block_amt_parsed;
+        data += block_amt_parsed;
 
-        // the entire block of hex was decoded. This is a simple state
+        // the entire block of hex was decoded. The data stays in the
+        // buffer until the address jumps or the buffer is full
         if (HEX_PARSE_OK == parse_status) {
-            if (bin_buf_written > 0) {
-                status = flash_decoder_write(bin_start_address, hex_state->bin_buffer, bin_buf_written);
-            }
-
             break;
         } else if (HEX_PARSE_UNALIGNED == parse_status) {
-            if (bin_buf_written > 0) {
-                status = flash_decoder_write(bin_start_address, hex_state->bin_buffer, bin_buf_written);
+            status = flush_hex(hex_state);
 
-                if (ERROR_SUCCESS != status) {
-                    break;
-                }
+            if (ERROR_SUCCESS != status) {
+                break;
             }
-
-            // incrememntal offset to finish the block
-            size -= block_amt_parsed;
-            data += block_amt_parsed;
         } else if (HEX_PARSE_EOF == parse_status) {
-            if (bin_buf_written > 0) {
-                status = flash_decoder_write(bin_start_address, hex_state->bin_buffer, bin_buf_written);
-            }
+            status = flush_hex(hex_state);
 
             if (ERROR_SUCCESS == status) {
                 status = ERROR_SUCCESS_DONE;
@@ -349,7 +363,7 @@ static error_t write_hex(void *state, const uint8_t *data, uint32_t size)
         } else if (HEX_PARSE_CKSUM_FAIL == parse_status) {
             status = ERROR_HEX_CKSUM;
             break;
-        } else if ((HEX_PARSE_UNINIT == parse_status) || (HEX_PARSE_FAILURE == parse_status)) {
+        } else {
             util_assert(HEX_PARSE_UNINIT != parse_status);
             status = ERROR_HEX_PARSER;
             break;
@@ -362,6 +376,16 @@ static error_t write_hex(void *state, const uint8_t *data, uint32_t size)
 static error_t close_hex(void *state)
 {
     error_t status;
+    error_t flush_status;
+    hex_state_t *hex_state = (hex_state_t *)state;
+    // Data is only buffered until the parser asks for a flush, so a
+    // file closed before its EOF record still has data to program
+    flush_status = flush_hex(hex_state);
     status = flash_decoder_close();
+
+    if (ERROR_SUCCESS != flush_status) {
+        status = flush_status;
+    }
+
     return status;
 }
@@ -250,10 +250,16 @@ error_t flash_decoder_write(uint32_t addr, const uint8_t *data, uint32_t size)
             flash_decoder_printf("    flash_start_addr=0x%x\r\n", flash_start_addr);
             // Initialize flash manager
             util_assert(!flash_initialized);
+            if (!flash_manager_claim()) {
+                state = DECODER_STATE_ERROR;
+                return ERROR_FLASH_BUSY;
+            }
+
             status = flash_manager_init(flash_intf);
             flash_decoder_printf("    flash_manager_init ret %i\r\n", status);
 
             if (ERROR_SUCCESS != status) {
+                flash_manager_release();
                 state = DECODER_STATE_ERROR;
                 return status;
             }
@@ -313,6 +319,7 @@ error_t flash_decoder_close(void)
     if (flash_initialized) {
         status = flash_manager_uninit();
         flash_decoder_printf("    flash_manager_uninit ret %i\r\n", status);
+        flash_manager_release();
     }
 
     if ((DECODER_STATE_DONE != prev_state) &&
@@ -53,6 +53,10 @@ extern const flash_intf_t *const flash_intf_iap_protected;
 extern const flash_intf_t *const flash_intf_target;
 extern const flash_intf_t *const flash_intf_target_custom;
 
+// Copy a bootloader update staged by flash_intf_iap_protected into place.
+// Does nothing if no complete update is staged.
+error_t flash_intf_iap_commit(void);
+
 #ifdef __cplusplus
 }
 #endif
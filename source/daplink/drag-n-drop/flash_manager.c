@@ -26,6 +26,7 @@
 #include "util.h"
 #include "macro.h"
 #include "error.h"
+#include "cortex_m.h"
 
 // Set to 1 to enable debugging
 #define DEBUG_FLASH_MANAGER     0
@@ -57,6 +58,7 @@ static uint32_t current_sector_size;
 static uint32_t last_addr;
 static const flash_intf_t *intf;
 static state_t state = STATE_CLOSED;
+static volatile bool claimed = false;
 
 static bool flash_intf_valid(const flash_intf_t *flash_intf);
 static error_t setup_next_sector(uint32_t addr);
@@ -243,6 +245,35 @@ void flash_manager_set_page_erase(bool enabled)
     page_erase_enabled = enabled;
 }
 
+bool flash_manager_get_page_erase(void)
+{
+    return page_erase_enabled;
+}
+
+bool flash_manager_claim(void)
+{
+    bool success;
+    cortex_int_state_t int_state;
+
+    int_state = cortex_int_get_and_disable();
+    success = !claimed;
+    claimed = true;
+    cortex_int_restore(int_state);
+    return success;
+}
+
+void flash_manager_release(void)
+{
+    // The session must be closed before giving up the flash manager
+    util_assert(STATE_CLOSED == state);
+    claimed = false;
+}
+
+bool flash_manager_busy(void)
+{
+    return claimed;
+}
+
 static bool flash_intf_valid(const flash_intf_t *flash_intf)
 {
     // Check for all requried members
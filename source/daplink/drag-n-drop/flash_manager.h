@@ -35,6 +35,15 @@ error_t flash_manager_init(const flash_intf_t *flash_intf);
 error_t flash_manager_data(uint32_t addr, const uint8_t *data, uint32_t size);
 error_t flash_manager_uninit(void);
 void flash_manager_set_page_erase(bool enabled);
+bool flash_manager_get_page_erase(void);
+
+// The MSC drag-n-drop and the CMSIS-DAP vendor commands run in different
+// threads, so a programming session claims the flash manager before
+// flash_manager_init and releases it after flash_manager_uninit. Target
+// memory reads outside of a DAP session claim it as well.
+bool flash_manager_claim(void);
+void flash_manager_release(void);
+bool flash_manager_busy(void);
 
 #ifdef __cplusplus
 }
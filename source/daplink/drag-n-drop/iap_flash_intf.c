@@ -44,6 +44,23 @@ COMPILER_ASSERT(DAPLINK_ROM_UPDATE_START % DAPLINK_SECTOR_SIZE == 0);
 // Update size must be a multiple of sector size
 COMPILER_ASSERT(DAPLINK_ROM_UPDATE_SIZE % DAPLINK_SECTOR_SIZE == 0);
 
+// HICs with spare flash define a staging region for the interface to
+// receive the bootloader into. The bootloader is only rewritten once the
+// whole image is in flash and verified, so a failed transfer leaves it
+// untouched and the transfer itself never runs with interrupts disabled
+// for longer than a staging sector erase. The staged image is copied into
+// place by flash_intf_iap_commit() once the host has stopped writing.
+#ifndef DAPLINK_ROM_STAGING_SIZE
+#define DAPLINK_ROM_STAGING_START       0
+#define DAPLINK_ROM_STAGING_SIZE        0
+#endif
+#ifndef DAPLINK_ROM_STAGING_SECTOR_SIZE
+#define DAPLINK_ROM_STAGING_SECTOR_SIZE DAPLINK_SECTOR_SIZE
+#endif
+#define STAGED_UPDATE                   (DAPLINK_ROM_STAGING_SIZE >= DAPLINK_ROM_UPDATE_SIZE)
+// Staging start must be aligned to a sector erase
+COMPILER_ASSERT(DAPLINK_ROM_STAGING_START % DAPLINK_ROM_STAGING_SECTOR_SIZE == 0);
+
 typedef enum {
     STATE_CLOSED,
     STATE_OPEN,
@@ -63,6 +80,9 @@ static bool sector_erase_allowed(uint32_t addr);
 static error_t intercept_page_write(uint32_t addr, const uint8_t *buf, uint32_t size);
 static error_t intercept_sector_erase(uint32_t addr);
 static error_t critical_erase_and_program(uint32_t addr, const uint8_t *data, uint32_t size);
+static error_t staged_page_write(uint32_t addr, const uint8_t *buf, uint32_t size);
+static error_t staged_commit(uint32_t image_crc);
+static error_t copy_sector(uint32_t addr, const uint8_t *data);
 
 static const flash_intf_t flash_intf = {
     init,
@@ -86,6 +106,9 @@ static bool current_page_set;
 static uint32_t current_page;
 static uint32_t current_page_write_size;
 static uint32_t crc;
+static uint32_t staging_erased_end;
+static bool staged_commit_pending;
+static uint32_t staged_crc;
 static uint8_t sector_buf[DAPLINK_SECTOR_SIZE];
 
 static error_t init()
@@ -117,6 +140,8 @@ static error_t init()
     current_page = 0;
     current_page_write_size = 0;
     crc = 0;
+    staging_erased_end = DAPLINK_ROM_STAGING_START;
+    staged_commit_pending = false;
     memset(sector_buf, 0, sizeof(sector_buf));
     state = STATE_OPEN;
     return ERROR_SUCCESS;
@@ -236,8 +261,8 @@ static error_t program_page(uint32_t addr, const uint8_t *buf, uint32_t size)
     }
 
     if (addr + size >= updt_end) {
-        // Something has been updated so recompute the crc
-        info_crc_compute();
+        // Something has been updated so drop the cached crcs
+        info_crc_invalidate();
         update_complete = true;
     }
 
@@ -389,6 +414,10 @@ static error_t intercept_page_write(uint32_t addr, const uint8_t *buf, uint32_t
     crc_size = MIN(size, updt_end - addr - 4);
     crc = crc32_continue(crc, buf, crc_size);
 
+    if (STAGED_UPDATE) {
+        return staged_page_write(addr, buf, size);
+    }
+
     // Intercept the data if it is in the first sector
     if ((addr >= updt_start) && (addr < updt_start + DAPLINK_SECTOR_SIZE)) {
         uint32_t buf_offset = addr - updt_start;
@@ -423,8 +452,14 @@ static error_t intercept_page_write(uint32_t addr, const uint8_t *buf, uint32_t
             status = ERROR_SUCCESS;
         }
 
-        // The bootloader has been updated so recompute the crc
-        info_crc_compute();
+        // The bootloader has been updated and its crc was checked
+        // as the pages came in, so there is no need to read it back
+        info_crc_invalidate();
+
+        if (ERROR_SUCCESS == status) {
+            info_crc_set_image(DAPLINK_ROM_UPDATE_START, crc);
+        }
+
         update_complete = true;
         return status;
     }
@@ -453,6 +488,11 @@ static error_t intercept_sector_erase(uint32_t addr)
 
     /* Everything below here is interface specific */
 
+    if (STAGED_UPDATE) {
+        // Nothing is erased until the staged image has been verified
+        return ERROR_SUCCESS;
+    }
+
     if (DAPLINK_ROM_UPDATE_START == addr) {
         uint32_t addr = DAPLINK_ROM_UPDATE_START;
         status = critical_erase_and_program(addr, (uint8_t *)DAPLINK_ROM_IF_START, DAPLINK_MIN_WRITE_SIZE);
@@ -497,3 +537,153 @@ static error_t critical_erase_and_program(uint32_t addr, const uint8_t *data, ui
 
     return ERROR_SUCCESS;
 }
+
+static error_t staged_page_write(uint32_t addr, const uint8_t *buf, uint32_t size)
+{
+    uint32_t iap_status;
+    uint32_t updt_end = DAPLINK_ROM_UPDATE_START + DAPLINK_ROM_UPDATE_SIZE;
+    uint32_t staging_addr = DAPLINK_ROM_STAGING_START + (addr - DAPLINK_ROM_UPDATE_START);
+
+    // Erase each staging sector before the first write to it
+    if (staging_addr >= staging_erased_end) {
+        uint32_t staging_sector = staging_addr - (staging_addr % DAPLINK_ROM_STAGING_SECTOR_SIZE);
+        iap_status = flash_erase_sector(staging_sector);
+
+        if (iap_status != 0) {
+            return ERROR_IAP_ERASE_SECTOR;
+        }
+
+        staging_erased_end = staging_sector + DAPLINK_ROM_STAGING_SECTOR_SIZE;
+    }
+
+    iap_status = flash_program_page(staging_addr, size, (uint8_t *)buf);
+
+    if (iap_status != 0) {
+        return ERROR_IAP_WRITE;
+    }
+
+    // The last page completes the staged image. Copying it into place
+    // takes too long for a USB write, so it is left to
+    // flash_intf_iap_commit().
+    if (updt_end == addr + size) {
+        uint32_t crc_in_image = (buf[size - 4] << 0) |
+                                (buf[size - 3] << 8) |
+                                (buf[size - 2] << 16) |
+                                (buf[size - 1] << 24);
+
+        if (crc != crc_in_image) {
+            return ERROR_BL_UPDT_BAD_CRC;
+        }
+
+        staged_crc = crc_in_image;
+        staged_commit_pending = true;
+        update_complete = true;
+    }
+
+    return ERROR_SUCCESS;
+}
+
+error_t flash_intf_iap_commit(void)
+{
+    int iap_status;
+    error_t status;
+
+    if (!staged_commit_pending) {
+        return ERROR_SUCCESS;
+    }
+
+    // The update session must be closed
+    if (state != STATE_CLOSED) {
+        util_assert(0);
+        return ERROR_INTERNAL;
+    }
+
+    staged_commit_pending = false;
+    iap_status = Init(0, 0, 0);
+
+    if (iap_status != 0) {
+        return ERROR_IAP_INIT;
+    }
+
+    status = staged_commit(staged_crc);
+    info_crc_invalidate();
+
+    if (ERROR_SUCCESS == status) {
+        info_crc_set_image(DAPLINK_ROM_UPDATE_START, staged_crc);
+    }
+
+    iap_status = UnInit(0);
+
+    if ((ERROR_SUCCESS == status) && (iap_status != 0)) {
+        status = ERROR_IAP_UNINIT;
+    }
+
+    return status;
+}
+
+// Copy the staged image over the update region
+static error_t staged_commit(uint32_t image_crc)
+{
+    uint32_t offset;
+    uint32_t updt_start = DAPLINK_ROM_UPDATE_START;
+    const uint8_t *staging = (const uint8_t *)DAPLINK_ROM_STAGING_START;
+    error_t status;
+
+    // Check the image as it was programmed before touching the bootloader
+    if (crc32(staging, DAPLINK_ROM_UPDATE_SIZE - 4) != image_crc) {
+        return ERROR_BL_UPDT_BAD_CRC;
+    }
+
+    // Boot the interface if power is lost from here on. The vector
+    // table is copied to RAM since the IAP can only program from RAM.
+    memcpy(sector_buf, (uint8_t *)DAPLINK_ROM_IF_START, DAPLINK_MIN_WRITE_SIZE);
+    status = critical_erase_and_program(updt_start, sector_buf, DAPLINK_MIN_WRITE_SIZE);
+
+    if (ERROR_SUCCESS != status) {
+        return status;
+    }
+
+    for (offset = DAPLINK_SECTOR_SIZE; offset < DAPLINK_ROM_UPDATE_SIZE; offset += DAPLINK_SECTOR_SIZE) {
+        memcpy(sector_buf, staging + offset, DAPLINK_SECTOR_SIZE);
+        status = copy_sector(updt_start + offset, sector_buf);
+
+        if (ERROR_SUCCESS != status) {
+            return status;
+        }
+    }
+
+    // Verify the copy, the first sector still comes from staging
+    if (crc32_continue(crc32(staging, DAPLINK_SECTOR_SIZE),
+                       (uint8_t *)updt_start + DAPLINK_SECTOR_SIZE,
+                       DAPLINK_ROM_UPDATE_SIZE - DAPLINK_SECTOR_SIZE - 4) != image_crc) {
+        return ERROR_BL_UPDT_BAD_CRC;
+    }
+
+    // CRITICAL SECTION BELOW HERE!
+    // Replace the interface's vector table
+    // with the one of the new bootloader.
+    memcpy(sector_buf, staging, DAPLINK_SECTOR_SIZE);
+    return copy_sector(updt_start, sector_buf);
+}
+
+static error_t copy_sector(uint32_t addr, const uint8_t *data)
+{
+    uint32_t iap_status;
+    uint32_t offset;
+
+    iap_status = flash_erase_sector(addr);
+
+    if (iap_status != 0) {
+        return ERROR_IAP_ERASE_SECTOR;
+    }
+
+    for (offset = 0; offset < DAPLINK_SECTOR_SIZE; offset += DAPLINK_MIN_WRITE_SIZE) {
+        iap_status = flash_program_page(addr + offset, DAPLINK_MIN_WRITE_SIZE, (uint8_t *)data + offset);
+
+        if (iap_status != 0) {
+            return ERROR_IAP_WRITE;
+        }
+    }
+
+    return ERROR_SUCCESS;
+}
@@ -33,198 +33,227 @@ enum hex_record_t {
     START_LINEAR_ADDR_RECORD = 5
 };
 
-typedef union hex_line_t hex_line_t;
-union __attribute__((packed)) hex_line_t {
-    uint8_t buf[0x25];
-    struct __attribute__((packed)) {
-        uint8_t  byte_count;
-        uint16_t address;
-        uint8_t  record_type;
-        uint8_t  data[0x25 - 0x5];
-        uint8_t  checksum;
-    };
+// Byte count, 16 bit address and record type
+#define RECORD_HEADER_SIZE  4U
+// Most data kept from a record that is not a data record
+#define RECORD_EXT_SIZE     0x20
+
+// Classes of the characters in char_table, hex digits are their value
+#define CHAR_HEX_MAX    0x0F
+#define CHAR_OTHER      0x10
+#define CHAR_START      0x20
+#define CHAR_EOL        0x40
+
+#define XX  CHAR_OTHER
+#define SR  CHAR_START
+#define EL  CHAR_EOL
+
+/** Value of each hex digit, or the class of any other character */
+static const uint8_t char_table[256] = {
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  EL,  XX,  XX,  EL,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+    0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9,  SR,  XX,  XX,  XX,  XX,  XX,
+     XX, 0xa, 0xb, 0xc, 0xd, 0xe, 0xf,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX, 0xa, 0xb, 0xc, 0xd, 0xe, 0xf,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
+     XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,  XX,
 };
 
-/** Swap 16bit value - let compiler figure out the best way
- *  @param val a variable of size uint16_t to be swapped
- *  @return the swapped value
- */
-static uint16_t swap16(uint16_t a)
+#undef XX
+#undef SR
+#undef EL
+
+// Record being decoded
+static uint8_t record_header[RECORD_HEADER_SIZE];
+static uint8_t record_ext[RECORD_EXT_SIZE];
+static uint32_t record_pos = 0;
+static uint8_t record_sum = 0, record_placed = 0, in_record = 0;
+static uint8_t high_nibble = 0, low_nibble = 0;
+// Address that record addresses are relative to
+static uint32_t base_address = 0;
+
+void reset_hex_parser(void)
 {
-    return ((a & 0x00ff) << 8) | ((a & 0xff00) >> 8);
+    memset(record_header, 0, sizeof(record_header));
+    record_pos = 0;
+    record_sum = 0;
+    record_placed = 0;
+    in_record = 0;
+    high_nibble = 0;
+    low_nibble = 0;
+    base_address = 0;
 }
 
-/** Converts a character representation of a hex to real value.
- *   @param c is the hex value in char format
- *   @return the value of the hex
+/** Find a place for the data of the record whose header was just decoded
+ *   Data records are decoded straight into the end of the output buffer.
+ *   @return HEX_PARSE_OK if the data has a place, HEX_PARSE_UNALIGNED if the
+ *   output buffer must be programmed first
  */
-static uint8_t ctoh(char c)
+static hexfile_parse_status_t place_record(const uint32_t bin_buf_size, uint32_t *bin_buf_address, uint32_t *bin_buf_cnt)
 {
-    return (c & 0x10) ? /*0-9*/ c & 0xf : /*A-F, a-f*/ (c & 0xf) + 9;
+    uint32_t count = record_header[0];
+    uint32_t address;
+
+    if (DATA_RECORD != record_header[3]) {
+        if (count > sizeof(record_ext)) {
+            return HEX_PARSE_LINE_OVERRUN;
+        }
+
+        record_placed = 1;
+        return HEX_PARSE_OK;
+    }
+
+    if (count > bin_buf_size) {
+        return HEX_PARSE_LINE_OVERRUN;
+    }
+
+    address = base_address + ((record_header[1] << 8) | record_header[2]);
+
+    if (0 == *bin_buf_cnt) {
+        *bin_buf_address = address;
+    } else if ((address != *bin_buf_address + *bin_buf_cnt) || (*bin_buf_cnt + count > bin_buf_size)) {
+        // Only an address jump or a full buffer needs the data to be programmed
+        return HEX_PARSE_UNALIGNED;
+    }
+
+    record_placed = 1;
+    return HEX_PARSE_OK;
 }
 
-/** Calculate checksum on a hex record
- *   @param data is the line of hex record
- *   @param size is the length of the data array
- *   @return 1 if the data provided is a valid hex record otherwise 0
+/** Check and act on a record once its line has ended
+ *   @return HEX_PARSE_OK to continue parsing, otherwise the reason to stop
  */
-static uint8_t validate_checksum(hex_line_t *record)
+static hexfile_parse_status_t finish_record(uint32_t *bin_buf_cnt)
 {
-    uint8_t result = 0, i = 0;
-
-    for (; i < (record->byte_count + 5); i++) {
-        result += record->buf[i];
+    if (low_nibble || (record_pos != RECORD_HEADER_SIZE + record_header[0] + 1U) || (record_sum != 0)) {
+        return HEX_PARSE_CKSUM_FAIL;
     }
 
-    return (result == 0);
-}
+    switch (record_header[3]) {
+        case DATA_RECORD:
+            // The data is already in place, just take it into the buffer
+            *bin_buf_cnt += record_header[0];
+            break;
 
-static hex_line_t line = {0}, shadow_line = {0};
-static uint32_t next_address_to_write = 0;
-static uint8_t low_nibble = 0, idx = 0, record_processed = 0, load_unaligned_record = 0;
+        case EOF_RECORD:
+            return HEX_PARSE_EOF;
 
-void reset_hex_parser(void)
-{
-    memset(line.buf, 0, sizeof(hex_line_t));
-    memset(shadow_line.buf, 0, sizeof(hex_line_t));
-    next_address_to_write = 0;
-    low_nibble = 0;
-    idx = 0;
-    record_processed = 0;
-    load_unaligned_record = 0;
+        case EXT_SEG_ADDR_RECORD:
+            base_address = ((record_ext[0] << 8) | record_ext[1]) << 4;
+            break;
+
+        case EXT_LINEAR_ADDR_RECORD:
+            base_address = ((record_ext[0] << 8) | record_ext[1]) << 16;
+            break;
+
+        default:
+            break;
+    }
+
+    return HEX_PARSE_OK;
 }
 
 hexfile_parse_status_t parse_hex_blob(const uint8_t *hex_blob, const uint32_t hex_blob_size, uint32_t *hex_parse_cnt, uint8_t *bin_buf, const uint32_t bin_buf_size, uint32_t *bin_buf_address, uint32_t *bin_buf_cnt)
 {
-    uint8_t *end = (uint8_t *)hex_blob + hex_blob_size;
-    hexfile_parse_status_t status = HEX_PARSE_UNINIT;
-    // reset the amount of data that is being return'd
-    *bin_buf_cnt = (uint32_t)0;
-
-    // we had an exit state where the address was unaligned to the previous record and data count.
-    //  Need to pop the last record into the buffer before decoding anthing else since it was
-    //  already decoded.
-    if (load_unaligned_record) {
-        // need some help...
-        load_unaligned_record = 0;
-        // move from line buffer back to input buffer
-        memcpy((uint8_t *)bin_buf, (uint8_t *)line.data, line.byte_count);
-        bin_buf += line.byte_count;
-        *bin_buf_cnt = (uint32_t)(*bin_buf_cnt) + line.byte_count;
-        // Store next address to write
-        next_address_to_write = ((next_address_to_write & 0xffff0000) | line.address) + line.byte_count;
+    const uint8_t *pos = hex_blob;
+    const uint8_t *end = hex_blob + hex_blob_size;
+    hexfile_parse_status_t status = HEX_PARSE_OK;
+    uint8_t *data = record_ext;
+    uint32_t index;
+    uint8_t code;
+    uint8_t value;
+
+    // The data of the record being decoded did not fit in the buffer
+    // last time, now that the buffer has been programmed it goes first
+    if (in_record && (record_pos >= RECORD_HEADER_SIZE) && !record_placed) {
+        status = place_record(bin_buf_size, bin_buf_address, bin_buf_cnt);
+
+        if (HEX_PARSE_OK != status) {
+            goto hex_parser_exit;
+        }
     }
 
-    while (hex_blob != end) {
-        switch ((uint8_t)(*hex_blob)) {
-            // we've hit the end of an ascii line
-            // junk we dont care about could also just run the validate_checksum on &line
-            case '\r':
-            case '\n':
-                if (0 == validate_checksum(&line)) {
-                    status = HEX_PARSE_CKSUM_FAIL;
-                    goto hex_parser_exit;
-                } else {
-                    if (!record_processed) {
-                        record_processed = 1;
-                        // address byteswap...
-                        line.address = swap16(line.address);
-
-                        switch (line.record_type) {
-                            case DATA_RECORD:
-                                // keeping a record of the last hex record
-                                memcpy(shadow_line.buf, line.buf, sizeof(hex_line_t));
-
-                                // verify this is a continous block of memory or need to exit and dump
-                                if (((next_address_to_write & 0xffff0000) | line.address) != next_address_to_write) {
-                                    load_unaligned_record = 1;
-                                    status = HEX_PARSE_UNALIGNED;
-                                    goto hex_parser_exit;
-                                }
-
-                                // move from line buffer back to input buffer
-                                memcpy(bin_buf, line.data, line.byte_count);
-                                bin_buf += line.byte_count;
-                                *bin_buf_cnt = (uint32_t)(*bin_buf_cnt) + line.byte_count;
-                                // Save next address to write
-                                next_address_to_write = ((next_address_to_write & 0xffff0000) | line.address) + line.byte_count;
-                                break;
-
-                            case EOF_RECORD:
-                                // pad rest of the buffer with 0xff
-                                //memset(bin_buf, 0xff, (bin_buf_size - (uint32_t)(*bin_buf_cnt)));
-                                //*bin_buf_cnt = bin_buf_size;
-                                status = HEX_PARSE_EOF;
-                                goto hex_parser_exit;
-
-                            case EXT_SEG_ADDR_RECORD:
-                                // Could have had data in the buffer so must exit and try to program
-                                //  before updating bin_buf_address with next_address_to_write
-                                memset(bin_buf, 0xff, (bin_buf_size - (uint32_t)(*bin_buf_cnt)));
-                                // figure the start address for the buffer before returning
-                                *bin_buf_address = next_address_to_write - (uint32_t)(*bin_buf_cnt);
-                                *hex_parse_cnt = (uint32_t)(hex_blob_size - (end - hex_blob));
-                                // update the address msb's
-                                next_address_to_write = (next_address_to_write & 0x00000000) | ((line.data[0] << 12) | (line.data[1] << 4));
-                                // Need to exit and program if buffer has been filled
-                                status = HEX_PARSE_UNALIGNED;
-                                return status;
-
-                            case EXT_LINEAR_ADDR_RECORD:
-                                // Could have had data in the buffer so must exit and try to program
-                                //  before updating bin_buf_address with next_address_to_write
-                                //  Good catch Gaute!!
-                                memset(bin_buf, 0xff, (bin_buf_size - (uint32_t)(*bin_buf_cnt)));
-                                // figure the start address for the buffer before returning
-                                *bin_buf_address = next_address_to_write - (uint32_t)(*bin_buf_cnt);
-                                *hex_parse_cnt = (uint32_t)(hex_blob_size - (end - hex_blob));
-                                // update the address msb's
-                                next_address_to_write = (next_address_to_write & 0x00000000) | ((line.data[0] << 24) | (line.data[1] << 16));
-                                // Need to exit and program if buffer has been filled
-                                status = HEX_PARSE_UNALIGNED;
-                                return status;
-
-                            default:
-                                break;
-                        }
-                    }
-                }
+    if (in_record && (record_pos >= RECORD_HEADER_SIZE) && (DATA_RECORD == record_header[3])) {
+        data = bin_buf + *bin_buf_cnt;
+    }
+
+    while (pos != end) {
+        code = char_table[*pos++];
+
+        if (code <= CHAR_HEX_MAX) {
+            // Hex digits outside of a record are ignored
+            if (!in_record) {
+                continue;
+            }
 
-                break;
-
-            // found start of a new record. reset state variables
-            case ':':
-                memset(line.buf, 0, sizeof(hex_line_t));
-                low_nibble = 0;
-                idx = 0;
-                record_processed = 0;
-                break;
-
-            // decoding lines
-            default:
-                if (low_nibble) {
-                    line.buf[idx] |= ctoh((uint8_t)(*hex_blob)) & 0xf;
-                    idx++;
-                } else {
-                    if (idx < sizeof(hex_line_t)) {
-                        line.buf[idx] = ctoh((uint8_t)(*hex_blob)) << 4;
+            if (!low_nibble) {
+                high_nibble = code << 4;
+                low_nibble = 1;
+                continue;
+            }
+
+            value = high_nibble | code;
+            low_nibble = 0;
+            record_sum += value;
+
+            if (record_pos < RECORD_HEADER_SIZE) {
+                record_header[record_pos++] = value;
+
+                if (RECORD_HEADER_SIZE == record_pos) {
+                    status = place_record(bin_buf_size, bin_buf_address, bin_buf_cnt);
+
+                    if (HEX_PARSE_OK != status) {
+                        goto hex_parser_exit;
                     }
+
+                    data = (DATA_RECORD == record_header[3]) ? bin_buf + *bin_buf_cnt : record_ext;
                 }
 
-                low_nibble = !low_nibble;
-                break;
-        }
+                continue;
+            }
 
-        hex_blob++;
+            index = record_pos - RECORD_HEADER_SIZE;
+
+            if (index < record_header[0]) {
+                data[index] = value;
+            } else if (index > record_header[0]) {
+                // More bytes than the byte count and the checksum
+                status = HEX_PARSE_LINE_OVERRUN;
+                goto hex_parser_exit;
+            }
+
+            record_pos++;
+        } else if (CHAR_START == code) {
+            in_record = 1;
+            record_pos = 0;
+            record_sum = 0;
+            record_placed = 0;
+            low_nibble = 0;
+        } else if (CHAR_EOL == code) {
+            if (in_record) {
+                in_record = 0;
+                status = finish_record(bin_buf_cnt);
+
+                if (HEX_PARSE_OK != status) {
+                    goto hex_parser_exit;
+                }
+            }
+        } else if (in_record) {
+            status = HEX_PARSE_FAILURE;
+            goto hex_parser_exit;
+        }
     }
 
-    // decoded an entire hex block - verify (cant do this hex_parse_cnt is figured below)
-    //status = (hex_blob_size == (uint32_t)(*hex_parse_cnt)) ? HEX_PARSE_OK : HEX_PARSE_FAILURE;
-    status = HEX_PARSE_OK;
 hex_parser_exit:
-    memset(bin_buf, 0xff, (bin_buf_size - (uint32_t)(*bin_buf_cnt)));
-    // figure the start address for the buffer before returning
-    *bin_buf_address = next_address_to_write - (uint32_t)(*bin_buf_cnt);
-    *hex_parse_cnt = (uint32_t)(hex_blob_size - (end - hex_blob));
+    *hex_parse_cnt = (uint32_t)(pos - hex_blob);
     return status;
 }
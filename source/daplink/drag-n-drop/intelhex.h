@@ -38,7 +38,7 @@ extern "C" {
 typedef enum {
     HEX_PARSE_OK = 0,       /*!< The input buffer was complete parsed and converted into the output buffer */
     HEX_PARSE_EOF,          /*!< EOF line found in the hex file */
-    HEX_PARSE_UNALIGNED,    /*!< The address of decoded data isnt consecutive. Need to program what was returned and continue to parse the input buffer */
+    HEX_PARSE_UNALIGNED,    /*!< The next record doesnt follow the data in the output buffer or doesnt fit. Need to program and empty the buffer and continue to parse the input buffer */
     HEX_PARSE_LINE_OVERRUN, /*!< Error state when the record length is longer than the record structure */
     HEX_PARSE_CKSUM_FAIL,   /*!< Error state when the record checksum doesnt properly compute */
     HEX_PARSE_UNINIT,       /*!< Default state. Return of this type is unrecoverable logic error */
@@ -52,13 +52,16 @@ typedef enum {
 void reset_hex_parser(void);
 
 /** Convert a blob of hex data into its binary equivelant
+ *  Decoded data is appended to bin_buf, which keeps its contents between calls
+ *  so it only has to be programmed when HEX_PARSE_UNALIGNED or HEX_PARSE_EOF
+ *  is returned. A record may be split between calls.
  *  @param hex_blob A block of ascii encoded hexfile data
  *  @param hex_blob_size The amount of valid data in the hex_blob
  *  @param hex_parse_cnt The amount of hex_blob data from the call that was parsed
  *  @param bin_buf Buffer the decoded hex file contents goes into
- *  @param bin_buf_size max size of the buffer
+ *  @param bin_buf_size max size of the buffer, at least the largest record (255 bytes)
  *  @param bin_buf_address The start address for data in the bin_buf as decoded from the hex file
- *  @param bin_buf_cnt The amount of data in the bin_buf
+ *  @param bin_buf_cnt The amount of data in the bin_buf, set to 0 by the caller once it is programmed
  *  @return A member of hex_parse_status_t that describes the state of decoding
  */
 hexfile_parse_status_t parse_hex_blob(const uint8_t *hex_blob, const uint32_t hex_blob_size, uint32_t *hex_parse_cnt, uint8_t *bin_buf, const uint32_t bin_buf_size, uint32_t *bin_buf_address, uint32_t *bin_buf_cnt);
@@ -19,6 +19,7 @@
  * limitations under the License.
  */
 
+#include "string.h"
 #include "stdbool.h"
 #include "ctype.h"
 
@@ -37,6 +38,7 @@
 #include "IO_Config.h"
 #include "target_reset.h"
 #include "file_stream.h"
+#include "flash_intf.h"
 #include "error.h"
 
 // Set to 1 to enable debugging
@@ -53,6 +55,7 @@
 
 #define CONNECT_DELAY_MS 0
 #define RECONNECT_DELAY_MS 2500    // Must be above 1s for windows (more for linux)
+#define RECONNECT_IN_PLACE_DELAY_MS 0   // Drive stays attached, host is sent a media change
 // TRANSFER_IN_PROGRESS
 #define DISCONNECT_DELAY_TRANSFER_TIMEOUT_MS 20000
 // TRANSFER_CAN_BE_FINISHED
@@ -63,6 +66,7 @@
 // Make sure none of the delays exceed the max time
 COMPILER_ASSERT(CONNECT_DELAY_MS < MAX_EVENT_TIME_MS);
 COMPILER_ASSERT(RECONNECT_DELAY_MS < MAX_EVENT_TIME_MS);
+COMPILER_ASSERT(RECONNECT_IN_PLACE_DELAY_MS < MAX_EVENT_TIME_MS);
 COMPILER_ASSERT(DISCONNECT_DELAY_TRANSFER_TIMEOUT_MS < MAX_EVENT_TIME_MS);
 COMPILER_ASSERT(DISCONNECT_DELAY_TRANSFER_IDLE_MS < MAX_EVENT_TIME_MS);
 COMPILER_ASSERT(DISCONNECT_DELAY_MS < MAX_EVENT_TIME_MS);
@@ -78,9 +82,12 @@ typedef struct {
     vfs_file_t file_to_program;     // A pointer to the directory entry of the file being programmed
     vfs_sector_t start_sector;      // Start sector of the file being programmed
     vfs_sector_t file_next_sector;  // Expected next sector of the file
-    vfs_sector_t last_ooo_sector;   // Last out of order sector within the file
+    uint32_t ooo_offset;            // Lowest file offset written again after it was received
+    vfs_sector_t guess_sector;      // First sector streamed on the assumption that the file is contiguous, not yet checked against the FAT
+    uint32_t guess_offset;          // File offset of guess_sector
     uint32_t size_processed;        // The number of bytes processed by the stream
     uint32_t file_size;             // Size of the file indicated by root dir.  Only allowed to increase
+    uint32_t chain_size;            // Size of the file's cluster chain once its end is in the FAT, otherwise 0
     uint32_t size_transferred;      // The number of bytes transferred
     transfer_state_t transfer_state;// Transfer state
     bool stream_open;               // State of the stream
@@ -89,6 +96,8 @@ typedef struct {
     bool stream_optional_finish;    // True if the stream processing can be considered done
     bool file_info_optional_finish; // True if the file transfer can be considered done
     bool transfer_timeout;          // Set if the transfer was finished because of a timeout. This only gets reset remount
+    bool reorder_overflow;          // Set if a sector was dropped because the reorder buffer was full
+    bool raw;                       // Set if the image is written to the raw LUN rather than as a file
     stream_type_t stream;           // Current stream or STREAM_TYPE_NONE is stream is closed.  This only gets reset remount
 } file_transfer_state_t;
 
@@ -102,10 +111,13 @@ static const file_transfer_state_t default_transfer_state = {
     VFS_FILE_INVALID,
     VFS_INVALID_SECTOR,
     VFS_INVALID_SECTOR,
+    VFS_INVALID_OFFSET,
     VFS_INVALID_SECTOR,
     0,
     0,
     0,
+    0,
+    0,
     TRANSFER_NOT_STARTED,
     false,
     false,
@@ -113,12 +125,25 @@ static const file_transfer_state_t default_transfer_state = {
     false,
     false,
     false,
+    false,
+    false,
     STREAM_TYPE_NONE,
 };
 
+#if (VFS_REORDER_SECTORS > 0)
+typedef struct {
+    uint32_t sector;                // Sector number or VFS_INVALID_SECTOR if unused
+    uint8_t data[VFS_SECTOR_SIZE];
+} reorder_sector_t;
+#endif
+
 static uint32_t usb_buffer[VFS_SECTOR_SIZE / sizeof(uint32_t)];
 static error_t fail_reason = ERROR_SUCCESS;
 static file_transfer_state_t file_transfer_state;
+#if (VFS_REORDER_SECTORS > 0)
+// Sectors that arrived ahead of the part of the file being streamed
+static reorder_sector_t reorder_buf[VFS_REORDER_SECTORS];
+#endif
 
 // These variables can be access from multiple threads
 // so access to them must be synchronized
@@ -146,6 +171,14 @@ static void transfer_update_file_info(vfs_file_t file, uint32_t start_sector, ui
 static void transfer_reset_file_info(void);
 static void transfer_stream_open(stream_type_t stream, uint32_t start_sector);
 static void transfer_stream_data(uint32_t sector, const uint8_t *data, uint32_t size);
+static uint32_t transfer_sector_offset(uint32_t sector, bool *guessed);
+static bool transfer_guess_valid(void);
+static void transfer_sector(uint32_t sector, const uint8_t *data);
+static void transfer_sector_in_order(uint32_t sector, const uint8_t *data);
+static void transfer_reorder_clear(void);
+static bool transfer_reorder_save(uint32_t sector, const uint8_t *data);
+static void transfer_reorder_drain(void);
+static void transfer_update_chain(void);
 static void transfer_update_state(error_t status);
 
 
@@ -195,9 +228,11 @@ void vfs_mngr_init(bool enable)
 void vfs_mngr_periodic(uint32_t elapsed_ms)
 {
     bool change_state;
+    error_t commit_status;
     vfs_mngr_state_t vfs_state_local;
     vfs_mngr_state_t vfs_state_local_prev;
     sync_assert_usb_thread();
+    vfs_user_periodic(elapsed_ms);
     sync_lock();
 
     // Return immediately if the desired state has been reached
@@ -261,6 +296,15 @@ void vfs_mngr_periodic(uint32_t elapsed_ms)
             }
 
             util_assert(TRASNFER_FINISHED == file_transfer_state.transfer_state);
+
+            // Finish a staged bootloader update now that the host
+            // is done writing
+            commit_status = flash_intf_iap_commit();
+
+            if (ERROR_SUCCESS == fail_reason) {
+                fail_reason = commit_status;
+            }
+
             vfs_user_disconnecting();
             break;
     }
@@ -272,11 +316,21 @@ void vfs_mngr_periodic(uint32_t elapsed_ms)
             break;
 
         case VFS_MNGR_STATE_RECONNECTING:
-            USBD_MSC_MediaReady = 0;
+            // With in-place remounting the old contents stay readable
+            // until the new filesystem is built
+            if (!config_get_remount_in_place()) {
+                USBD_MSC_MediaReady = 0;
+            }
             break;
 
         case VFS_MNGR_STATE_CONNECTED:
             build_filesystem();
+
+            // Tell the host to drop its cached copy of the drive
+            if ((VFS_MNGR_STATE_RECONNECTING == vfs_state_local_prev) && USBD_MSC_MediaReady) {
+                USBD_MSC_MediaChanged = 1;
+            }
+
             USBD_MSC_MediaReady = 1;
             break;
     }
@@ -334,6 +388,11 @@ void usbd_msc_write_sect(uint32_t sector, uint8_t *buf, uint32_t num_of_sectors)
     // indicate msc activity
     main_blink_msc_led(MAIN_LED_OFF);
     vfs_write(sector, buf, num_of_sectors);
+    // Files do not take part in an image coming over the raw LUN
+    if ((TRASNFER_FINISHED == file_transfer_state.transfer_state) || file_transfer_state.raw) {
+        return;
+    }
+    transfer_update_chain();
     if (TRASNFER_FINISHED == file_transfer_state.transfer_state) {
         return;
     }
@@ -370,6 +429,7 @@ static void build_filesystem()
 {
     // Update anything that could have changed file system state
     file_transfer_state = default_transfer_state;
+    transfer_reorder_clear();
     vfs_user_build_filesystem();
     vfs_set_file_change_callback(file_change_handler);
     // Set mass storage parameters
@@ -424,12 +484,69 @@ static void file_change_handler(const vfs_filename_t filename, vfs_file_change_t
     }
 }
 
+#if (MSC_RAW_LUN != 0)
+// Handler for blocks written to the raw LUN.  The LUN has no filesystem so
+// an image is streamed as it arrives, starting at block 0 and in LBA order.
+void usbd_msc_raw_write_sect(uint32_t sector, uint8_t *buf, uint32_t num_of_sectors)
+{
+    stream_type_t stream;
+    uint32_t i;
+    sync_assert_usb_thread();
+
+    if (!USBD_MSC_MediaReady) {
+        return;
+    }
+
+    time_usb_idle = 0;
+
+    if (TRASNFER_FINISHED == file_transfer_state.transfer_state) {
+        return;
+    }
+
+    main_blink_msc_led(MAIN_LED_OFF);
+
+    if (!file_transfer_state.stream_started) {
+        // Only the first block of an image can start a transfer
+        if (0 != sector) {
+            return;
+        }
+
+        stream = stream_start_identify((uint8_t *)buf, VFS_SECTOR_SIZE * num_of_sectors);
+
+        if (STREAM_TYPE_NONE == stream) {
+            return;
+        }
+
+        file_transfer_state.raw = true;
+        transfer_stream_open(stream, sector);
+    } else if (!file_transfer_state.raw) {
+        // A file is already being programmed from the drive
+        transfer_update_state(ERROR_ERROR_DURING_TRANSFER);
+        return;
+    }
+
+    for (i = 0; i < num_of_sectors; i++) {
+        if (TRASNFER_FINISHED == file_transfer_state.transfer_state) {
+            return;
+        }
+
+        if (sector + i != file_transfer_state.file_next_sector) {
+            vfs_mngr_printf("vfs_manager raw sector %i out of order, expected %i\r\n",
+                            sector + i, file_transfer_state.file_next_sector);
+            transfer_update_state(ERROR_OOO_SECTOR);
+            return;
+        }
+
+        transfer_sector_in_order(sector + i, buf + i * VFS_SECTOR_SIZE);
+    }
+}
+#endif
+
 // Handler for file data arriving over USB.  This function is responsible
 // for detecting the start of a BIN/HEX file and performing programming
 static void file_data_handler(uint32_t sector, const uint8_t *buf, uint32_t num_of_sectors)
 {
     stream_type_t stream;
-    uint32_t size;
 
     // this is the key for starting a file write - we dont care what file types are sent
     //  just look for something unique (NVIC table, hex, srec, etc) until root dir is updated
@@ -443,49 +560,16 @@ static void file_data_handler(uint32_t sector, const uint8_t *buf, uint32_t num_
     }
 
     if (file_transfer_state.stream_started) {
-        // Ignore sectors coming before this file
-        if (sector < file_transfer_state.start_sector) {
-            return;
-        }
-
-        // sectors must be in order
-        if (sector != file_transfer_state.file_next_sector) {
-            vfs_mngr_printf("vfs_manager file_data_handler sector=%i\r\n", sector);
-
-            if (sector < file_transfer_state.file_next_sector) {
-                vfs_mngr_printf("    sector out of order! lowest ooo = %i\r\n",
-                                file_transfer_state.last_ooo_sector);
+        uint32_t i;
 
-                if (VFS_INVALID_SECTOR == file_transfer_state.last_ooo_sector) {
-                    file_transfer_state.last_ooo_sector = sector;
-                }
+        // Sectors of a fragmented file can be anywhere so look at them one by one
+        for (i = 0; i < num_of_sectors; i++) {
+            transfer_sector(sector + i, buf + i * VFS_SECTOR_SIZE);
 
-                file_transfer_state.last_ooo_sector =
-                    MIN(file_transfer_state.last_ooo_sector, sector);
-            } else {
-                vfs_mngr_printf("    sector not part of file transfer\r\n");
+            if (TRASNFER_FINISHED == file_transfer_state.transfer_state) {
+                return;
             }
-
-            vfs_mngr_printf("    discarding data - size transferred=0x%x, data=%x,%x,%x,%x,...\r\n",
-                            file_transfer_state.size_transferred, buf[0], buf[1], buf[2], buf[3]);
-            return;
         }
-
-        // This sector could be part of the file so record it
-        size = VFS_SECTOR_SIZE * num_of_sectors;
-        file_transfer_state.size_transferred += size;
-        file_transfer_state.file_next_sector = sector + num_of_sectors;
-
-        // If stream processing is done then discard the data
-        if (file_transfer_state.stream_finished) {
-            vfs_mngr_printf("vfs_manager file_data_handler\r\n    sector=%i, size=%i\r\n", sector, size);
-            vfs_mngr_printf("    discarding data - size transferred=0x%x, data=%x,%x,%x,%x,...\r\n",
-                            file_transfer_state.size_transferred, buf[0], buf[1], buf[2], buf[3]);
-            transfer_update_state(ERROR_SUCCESS);
-            return;
-        }
-
-        transfer_stream_data(sector, buf, size);
     }
 }
 
@@ -519,7 +603,7 @@ static bool ready_for_state_change(void)
         timeout_ms = CONNECT_DELAY_MS;
     } else if ((VFS_MNGR_STATE_RECONNECTING == vfs_state) &&
                (VFS_MNGR_STATE_CONNECTED == vfs_state_next)) {
-        timeout_ms = RECONNECT_DELAY_MS;
+        timeout_ms = config_get_remount_in_place() ? RECONNECT_IN_PLACE_DELAY_MS : RECONNECT_DELAY_MS;
     } else if ((VFS_MNGR_STATE_RECONNECTING == vfs_state) &&
                (VFS_MNGR_STATE_DISCONNECTED == vfs_state_next)) {
         timeout_ms = 0;
@@ -619,6 +703,7 @@ static void transfer_reset_file_info()
         transfer_update_state(ERROR_ERROR_DURING_TRANSFER);
     } else {
         file_transfer_state = default_transfer_state;
+        transfer_reorder_clear();
         abort_remount();
     }
 }
@@ -714,6 +799,264 @@ static void transfer_stream_data(uint32_t sector, const uint8_t *data, uint32_t
     transfer_update_state(status);
 }
 
+// Get the offset of a sector within the file being transferred, or
+// VFS_INVALID_OFFSET if it is not known to be part of the file
+static uint32_t transfer_sector_offset(uint32_t sector, bool *guessed)
+{
+    uint32_t known_size;
+    uint32_t offset;
+
+    *guessed = false;
+    offset = vfs_get_chain_offset(file_transfer_state.start_sector, sector, &known_size);
+
+    if ((VFS_INVALID_OFFSET != offset) || (0 != file_transfer_state.chain_size) ||
+            (known_size > file_transfer_state.size_transferred)) {
+        return offset;
+    }
+
+    // Past the part of the chain in the FAT assume the file is contiguous
+    if (sector == file_transfer_state.file_next_sector) {
+        *guessed = true;
+        return file_transfer_state.size_transferred;
+    }
+
+    if ((sector >= file_transfer_state.start_sector) && (sector < file_transfer_state.file_next_sector) &&
+            ((file_transfer_state.file_next_sector - file_transfer_state.start_sector) * VFS_SECTOR_SIZE ==
+             file_transfer_state.size_transferred)) {
+        return (sector - file_transfer_state.start_sector) * VFS_SECTOR_SIZE;
+    }
+
+    return VFS_INVALID_OFFSET;
+}
+
+// Handle a sector written while a file is being streamed
+static void transfer_sector(uint32_t sector, const uint8_t *data)
+{
+    bool guessed;
+    uint32_t offset = transfer_sector_offset(sector, &guessed);
+
+    if (offset == file_transfer_state.size_transferred) {
+        if (guessed && (VFS_INVALID_SECTOR == file_transfer_state.guess_sector)) {
+            file_transfer_state.guess_sector = sector;
+            file_transfer_state.guess_offset = offset;
+        }
+
+        transfer_sector_in_order(sector, data);
+        transfer_reorder_drain();
+        return;
+    }
+
+    vfs_mngr_printf("vfs_manager transfer_sector sector=%i\r\n", sector);
+
+    if (offset < file_transfer_state.size_transferred) {
+        vfs_mngr_printf("    sector out of order! lowest ooo = %i\r\n", file_transfer_state.ooo_offset);
+        file_transfer_state.ooo_offset = MIN(file_transfer_state.ooo_offset, offset);
+        return;
+    }
+
+    // Keep later parts of the file, and sectors that could still turn out to
+    // be part of it, until the data before them has been streamed
+    if ((VFS_INVALID_OFFSET != offset) || (0 == file_transfer_state.chain_size)) {
+        if (transfer_reorder_save(sector, data)) {
+            return;
+        }
+
+        if (VFS_INVALID_OFFSET != offset) {
+            vfs_mngr_printf("    reorder buffer full\r\n");
+            file_transfer_state.reorder_overflow = true;
+            return;
+        }
+    }
+
+    vfs_mngr_printf("    discarding data - size transferred=0x%x, data=%x,%x,%x,%x,...\r\n",
+                    file_transfer_state.size_transferred, data[0], data[1], data[2], data[3]);
+}
+
+// Stream the sector at the current end of the received part of the file
+static void transfer_sector_in_order(uint32_t sector, const uint8_t *data)
+{
+    file_transfer_state.size_transferred += VFS_SECTOR_SIZE;
+    file_transfer_state.file_next_sector = sector + 1;
+
+    // If stream processing is done then discard the data
+    if (file_transfer_state.stream_finished) {
+        vfs_mngr_printf("vfs_manager transfer_sector_in_order sector=%i\r\n", sector);
+        vfs_mngr_printf("    discarding data - size transferred=0x%x, data=%x,%x,%x,%x,...\r\n",
+                        file_transfer_state.size_transferred, data[0], data[1], data[2], data[3]);
+        transfer_update_state(ERROR_SUCCESS);
+        return;
+    }
+
+    transfer_stream_data(sector, data, VFS_SECTOR_SIZE);
+}
+
+static void transfer_reorder_clear(void)
+{
+#if (VFS_REORDER_SECTORS > 0)
+    uint32_t i;
+
+    for (i = 0; i < VFS_REORDER_SECTORS; i++) {
+        reorder_buf[i].sector = VFS_INVALID_SECTOR;
+    }
+#endif
+}
+
+static bool transfer_reorder_save(uint32_t sector, const uint8_t *data)
+{
+#if (VFS_REORDER_SECTORS > 0)
+    reorder_sector_t *slot = 0;
+    bool guessed;
+    uint32_t i;
+
+    for (i = 0; i < VFS_REORDER_SECTORS; i++) {
+        if (reorder_buf[i].sector == sector) {
+            slot = &reorder_buf[i];
+            break;
+        }
+
+        if ((0 == slot) && (VFS_INVALID_SECTOR == reorder_buf[i].sector)) {
+            slot = &reorder_buf[i];
+        }
+    }
+
+    // When full make room for part of the file by dropping a
+    // sector that is not known to belong to it
+    if ((0 == slot) && (VFS_INVALID_OFFSET != transfer_sector_offset(sector, &guessed))) {
+        for (i = 0; i < VFS_REORDER_SECTORS; i++) {
+            if (VFS_INVALID_OFFSET == transfer_sector_offset(reorder_buf[i].sector, &guessed)) {
+                slot = &reorder_buf[i];
+                break;
+            }
+        }
+    }
+
+    if (0 == slot) {
+        return false;
+    }
+
+    slot->sector = sector;
+    memcpy(slot->data, data, VFS_SECTOR_SIZE);
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Stream saved sectors that the file has caught up with
+static void transfer_reorder_drain(void)
+{
+#if (VFS_REORDER_SECTORS > 0)
+    bool progress = true;
+    bool guessed;
+    uint32_t sector;
+    uint32_t offset;
+    uint32_t i;
+
+    while (progress && (TRASNFER_FINISHED != file_transfer_state.transfer_state)) {
+        progress = false;
+
+        for (i = 0; i < VFS_REORDER_SECTORS; i++) {
+            sector = reorder_buf[i].sector;
+
+            if (VFS_INVALID_SECTOR == sector) {
+                continue;
+            }
+
+            offset = transfer_sector_offset(sector, &guessed);
+
+            if (offset == file_transfer_state.size_transferred) {
+                if (guessed && (VFS_INVALID_SECTOR == file_transfer_state.guess_sector)) {
+                    file_transfer_state.guess_sector = sector;
+                    file_transfer_state.guess_offset = offset;
+                }
+
+                reorder_buf[i].sector = VFS_INVALID_SECTOR;
+                transfer_sector_in_order(sector, reorder_buf[i].data);
+                progress = true;
+                break;
+            }
+
+            // Drop sectors already received or known not to be part of the file
+            if ((offset < file_transfer_state.size_transferred) ||
+                    ((VFS_INVALID_OFFSET == offset) && (0 != file_transfer_state.chain_size))) {
+                reorder_buf[i].sector = VFS_INVALID_SECTOR;
+            }
+        }
+    }
+#endif
+}
+
+// Check the sectors streamed on the assumption that the file is contiguous
+// against the part of the chain the host has since written to the FAT
+static bool transfer_guess_valid(void)
+{
+    const uint32_t sectors_per_cluster = vfs_get_cluster_size() / VFS_SECTOR_SIZE;
+    uint32_t sector = file_transfer_state.guess_sector;
+    uint32_t offset = file_transfer_state.guess_offset;
+    uint32_t chain_offset;
+    uint32_t known_size;
+    uint32_t skip;
+
+    while (sector < file_transfer_state.file_next_sector) {
+        chain_offset = vfs_get_chain_offset(file_transfer_state.start_sector, sector, &known_size);
+
+        if (VFS_INVALID_OFFSET == chain_offset) {
+            if (known_size > offset) {
+                return false;
+            }
+
+            // The FAT does not reach this part of the file yet
+            file_transfer_state.guess_sector = sector;
+            file_transfer_state.guess_offset = offset;
+            return true;
+        }
+
+        if (chain_offset != offset) {
+            return false;
+        }
+
+        // The rest of the cluster follows from this sector
+        skip = sectors_per_cluster - (sector - file_transfer_state.start_sector) % sectors_per_cluster;
+        sector += skip;
+        offset += skip * VFS_SECTOR_SIZE;
+    }
+
+    file_transfer_state.guess_sector = VFS_INVALID_SECTOR;
+    return true;
+}
+
+// Update the transfer state when the host writes the file's cluster chain
+static void transfer_update_chain(void)
+{
+    uint32_t chain_size;
+
+    if (VFS_INVALID_SECTOR == file_transfer_state.start_sector) {
+        return;
+    }
+
+    if ((VFS_INVALID_SECTOR != file_transfer_state.guess_sector) && !transfer_guess_valid()) {
+        vfs_mngr_printf("vfs_manager transfer_update_chain\r\n    error: file is not contiguous\r\n");
+        transfer_update_state(ERROR_OOO_SECTOR);
+        return;
+    }
+
+    transfer_reorder_drain();
+
+    if (TRASNFER_FINISHED == file_transfer_state.transfer_state) {
+        return;
+    }
+
+    chain_size = vfs_get_chain_size(file_transfer_state.start_sector);
+
+    if (chain_size == file_transfer_state.chain_size) {
+        return;
+    }
+
+    vfs_mngr_printf("vfs_manager transfer_update_chain(chain_size=%i)\r\n", chain_size);
+    file_transfer_state.chain_size = chain_size;
+    transfer_update_state(ERROR_SUCCESS);
+}
+
 // Check if the current transfer is still in progress, done, or if an error has occurred
 static void transfer_update_state(error_t status)
 {
@@ -721,6 +1064,7 @@ static void transfer_update_state(error_t status)
     bool transfer_started;
     bool transfer_can_be_finished;
     bool transfer_must_be_finished;
+    bool file_complete;
     bool out_of_order_sector;
     error_t local_status = status;
     util_assert((status != ERROR_SUCCESS_DONE) &&
@@ -737,10 +1081,16 @@ static void transfer_update_state(error_t status)
     // 1. A file has been detected
     // 2. The size of the file indicated in the root dir has been transferred
     // 3. The file size is greater than zero
-    file_transfer_state.file_info_optional_finish =
-        (file_transfer_state.file_to_program != VFS_FILE_INVALID) &&
-        (file_transfer_state.size_transferred >= file_transfer_state.file_size) &&
-        (file_transfer_state.file_size > 0);
+    // An image on the raw LUN has no file so only the stream decides
+    file_transfer_state.file_info_optional_finish = file_transfer_state.raw ||
+        ((file_transfer_state.file_to_program != VFS_FILE_INVALID) &&
+         (file_transfer_state.size_transferred >= file_transfer_state.file_size) &&
+         (file_transfer_state.file_size > 0));
+    // The end of the file is known for sure once the host has linked its
+    // last cluster in the FAT and the chain matches the size in the root dir
+    file_complete = !file_transfer_state.raw && file_transfer_state.file_info_optional_finish &&
+                    (file_transfer_state.chain_size >= file_transfer_state.file_size) &&
+                    (file_transfer_state.chain_size - file_transfer_state.file_size < vfs_get_cluster_size());
     transfer_timeout = file_transfer_state.transfer_timeout;
     transfer_started = (VFS_FILE_INVALID != file_transfer_state.file_to_program) ||
                        (STREAM_TYPE_NONE != file_transfer_state.stream);
@@ -749,22 +1099,13 @@ static void transfer_update_state(error_t status)
     transfer_can_be_finished = file_transfer_state.file_info_optional_finish &&
                                file_transfer_state.stream_optional_finish;
     // The transfer must be fnished if stream processing is for sure complete
-    // and file processing can be considered complete
-    transfer_must_be_finished = file_transfer_state.stream_finished &&
-                                file_transfer_state.file_info_optional_finish;
-    out_of_order_sector = false;
-
-    if (file_transfer_state.last_ooo_sector != VFS_INVALID_SECTOR) {
-        util_assert(file_transfer_state.start_sector != VFS_INVALID_SECTOR);
-        uint32_t sector_offset = (file_transfer_state.last_ooo_sector -
-                                  file_transfer_state.start_sector) * VFS_SECTOR_SIZE;
-
-        if (sector_offset < file_transfer_state.size_processed) {
-            // The out of order sector was within the range of data already
-            // processed.
-            out_of_order_sector = true;
-        }
-    }
+    // and file processing can be considered complete, or if all of the file
+    // has been received
+    transfer_must_be_finished = (file_transfer_state.stream_finished &&
+                                 file_transfer_state.file_info_optional_finish) ||
+                                file_complete;
+    // The out of order sector was within the range of data already processed
+    out_of_order_sector = file_transfer_state.ooo_offset < file_transfer_state.size_processed;
 
     // Set the transfer state and set the status if necessary
     if (local_status != ERROR_SUCCESS) {
@@ -776,6 +1117,8 @@ static void transfer_update_state(error_t status)
             local_status = ERROR_SUCCESS;
         } else if (transfer_can_be_finished) {
             local_status = ERROR_SUCCESS;
+        } else if (file_transfer_state.reorder_overflow) {
+            local_status = ERROR_OOO_SECTOR;
         } else {
             local_status = ERROR_TRANSFER_TIMEOUT;
         }
@@ -32,6 +32,12 @@
 extern "C" {
 #endif
 
+// Number of sectors that can be held while waiting for earlier parts of a
+// fragmented file, HICs with spare RAM raise this
+#ifndef VFS_REORDER_SECTORS
+#define VFS_REORDER_SECTORS 0
+#endif
+
 extern const vfs_filename_t daplink_mode_file_name;
 extern const vfs_filename_t daplink_drive_name;
 extern const vfs_filename_t daplink_url_name;
@@ -74,6 +80,9 @@ void vfs_user_file_change_handler(const vfs_filename_t filename, vfs_file_change
 // Called when VFS is disconnecting
 void vfs_user_disconnecting(void);
 
+// Called from vfs_mngr_periodic
+void vfs_user_periodic(uint32_t elapsed_ms);
+
 
 #ifdef __cplusplus
 }
@@ -34,12 +34,30 @@
 #include "info.h"
 #include "gpio.h"           // for gpio_get_sw_reset
 #include "flash_intf.h"     // for flash_intf_target
+#include "flash_manager.h"  // for flash_manager_claim
 #include "cortex_m.h"
+#if defined(DAP_PROFILE) && (DAP_PROFILE != 0)
+#include "dap_profile.h"
+#endif
+#if defined(DAPLINK_IF)
+#include "target_config.h"
+#include "swd_host.h"
+#include "DAP_config.h"
+#include "DAP.h"
+#endif
 
 // Must be bigger than 4x the flash size of the biggest supported
 // device.  This is to accomodate for hex file programming.
 static const uint32_t disc_size = MB(64);
 
+// FLASH.BIN and RAM.BIN reads keep the target connected between
+// sectors until there has been no read for this long
+#define TARGET_READ_IDLE_MS 200
+
+// Clusters are sized so an image of the whole flash spans about this
+// many of them, which keeps the FAT updates per copied file low
+#define IMAGE_CLUSTERS  64
+
 static const char mbed_redirect_file[] =
     "<!doctype html>\r\n"
     "<!-- mbed Platform Website and Authentication Shortcut -->\r\n"
@@ -62,15 +80,28 @@ static char assert_buf[64 + 1];
 static uint16_t assert_line;
 static assert_source_t assert_source;
 static uint32_t remount_count;
+#if defined(DAPLINK_IF)
+static bool target_read_connected;
+static uint32_t target_read_idle_ms;
+#endif
 
 static uint32_t get_file_size(vfs_read_cb_t read_func);
 
 static uint32_t read_file_mbed_htm(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors);
 static uint32_t read_file_details_txt(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors);
+static uint32_t write_details_txt(char *buf, bool with_crc);
 static uint32_t read_file_fail_txt(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors);
 static uint32_t read_file_assert_txt(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors);
 static uint32_t read_file_need_bl_txt(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors);
+#if (DAP_PROFILE != 0)
+static uint32_t read_file_profile_txt(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors);
+#endif
+#if defined(DAPLINK_IF)
+static uint32_t read_file_flash_bin(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors);
+static uint32_t read_file_ram_bin(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors);
+#endif
 
+static uint32_t get_image_size(void);
 static void insert(uint8_t *buf, uint8_t *new_str, uint32_t strip_count);
 static void update_html_file(uint8_t *buf, uint32_t bufsize);
 static void erase_target(void);
@@ -80,12 +111,15 @@ void vfs_user_build_filesystem()
     uint32_t file_size;
     vfs_file_t file_handle;
     // Setup the filesystem based on target parameters
-    vfs_init(daplink_drive_name, disc_size);
+    file_size = get_image_size();
+    vfs_init(daplink_drive_name, MAX(disc_size, file_size * 4), file_size / IMAGE_CLUSTERS);
     // MBED.HTM
     file_size = get_file_size(read_file_mbed_htm);
     vfs_create_file(daplink_url_name, read_file_mbed_htm, 0, file_size);
     // DETAILS.TXT
-    file_size = get_file_size(read_file_details_txt);
+    // The CRC lines have a fixed width, so the size is found without
+    // computing the CRCs of the flash regions on the boot path
+    file_size = write_details_txt((char *)file_buffer, false);
     vfs_create_file("DETAILS TXT", read_file_details_txt, 0, file_size);
 
     // FAIL.TXT
@@ -114,6 +148,28 @@ void vfs_user_build_filesystem()
         file_size = get_file_size(read_file_need_bl_txt);
         vfs_create_file("NEED_BL TXT", read_file_need_bl_txt, 0, file_size);
     }
+
+#if defined(DAPLINK_IF)
+    // FLASH.BIN
+    if (config_get_memory_files() && (target_device.flash_end > target_device.flash_start)) {
+        file_handle = vfs_create_file("FLASH   BIN", read_file_flash_bin, 0, target_device.flash_end - target_device.flash_start);
+        vfs_file_set_uncached(file_handle);
+    }
+
+    // RAM.BIN
+    if (config_get_memory_files() && (target_device.ram_end > target_device.ram_start)) {
+        file_handle = vfs_create_file("RAM     BIN", read_file_ram_bin, 0, target_device.ram_end - target_device.ram_start);
+        vfs_file_set_uncached(file_handle);
+    }
+#endif
+
+#if (DAP_PROFILE != 0)
+    // PROFILE.TXT
+    if (daplink_is_interface()) {
+        file_handle = vfs_create_file("PROFILE TXT", read_file_profile_txt, 0, VFS_SECTOR_SIZE);
+        vfs_file_set_uncached(file_handle);
+    }
+#endif
 }
 
 // Callback to handle changes to the root directory.  Should be used with vfs_set_file_change_callback
@@ -167,6 +223,18 @@ void vfs_user_file_change_handler(const vfs_filename_t filename, vfs_file_change
         } else if (!memcmp(filename, "OVFL_OFFCFG", sizeof(vfs_filename_t))) {
             config_set_overflow_detect(false);
             vfs_mngr_fs_remount();
+        } else if (!memcmp(filename, "RMNT_ON CFG", sizeof(vfs_filename_t))) {
+            config_set_remount_in_place(true);
+            vfs_mngr_fs_remount();
+        } else if (!memcmp(filename, "RMNT_OFFCFG", sizeof(vfs_filename_t))) {
+            config_set_remount_in_place(false);
+            vfs_mngr_fs_remount();
+        } else if (!memcmp(filename, "MEM_ON  CFG", sizeof(vfs_filename_t))) {
+            config_set_memory_files(true);
+            vfs_mngr_fs_remount();
+        } else if (!memcmp(filename, "MEM_OFF CFG", sizeof(vfs_filename_t))) {
+            config_set_memory_files(false);
+            vfs_mngr_fs_remount();
         }
     }
 
@@ -194,6 +262,35 @@ void vfs_user_disconnecting()
     remount_count++;
 }
 
+void vfs_user_periodic(uint32_t elapsed_ms)
+{
+#if defined(DAPLINK_IF)
+    if (!target_read_connected) {
+        return;
+    }
+
+    target_read_idle_ms += elapsed_ms;
+
+    if (target_read_idle_ms < TARGET_READ_IDLE_MS) {
+        return;
+    }
+
+    // Only turn the port off if nothing else took it over
+    DAP_Lock();
+
+    if (flash_manager_claim()) {
+        if (DAP_Data.debug_port == DAP_PORT_DISABLED) {
+            swd_off();
+        }
+
+        flash_manager_release();
+    }
+
+    target_read_connected = false;
+    DAP_Unlock();
+#endif
+}
+
 // Get the filesize from a filesize callback.
 // The file data must be null terminated for this to work correctly.
 static uint32_t get_file_size(vfs_read_cb_t read_func)
@@ -216,14 +313,20 @@ static uint32_t read_file_mbed_htm(uint32_t sector_offset, uint8_t *data, uint32
 // File callback to be used with vfs_add_file to return file contents
 static uint32_t read_file_details_txt(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors)
 {
-    uint32_t pos;
-    const char *mode_str;
-    char *buf = (char *)data;
-
     if (sector_offset != 0) {
         return 0;
     }
 
+    return write_details_txt((char *)data, true);
+}
+
+// Write the contents of DETAILS.TXT. Without with_crc the CRC lines are
+// written as zeros, which gives the same length.
+static uint32_t write_details_txt(char *buf, bool with_crc)
+{
+    uint32_t pos;
+    const char *mode_str;
+
     pos = 0;
     pos += util_write_string(buf + pos, "# DAPLink Firmware - see https://mbed.com/daplink\r\n");
     // Unique ID
@@ -244,6 +347,12 @@ static uint32_t read_file_details_txt(uint32_t sector_offset, uint8_t *data, uin
     pos += util_write_string(buf + pos, "Overflow detection: ");
     pos += util_write_string(buf + pos, config_get_overflow_detect() ? "1" : "0");
     pos += util_write_string(buf + pos, "\r\n");
+    pos += util_write_string(buf + pos, "Remount in place: ");
+    pos += util_write_string(buf + pos, config_get_remount_in_place() ? "1" : "0");
+    pos += util_write_string(buf + pos, "\r\n");
+    pos += util_write_string(buf + pos, "Memory files: ");
+    pos += util_write_string(buf + pos, config_get_memory_files() ? "1" : "0");
+    pos += util_write_string(buf + pos, "\r\n");
     // Current mode
     mode_str = daplink_is_bootloader() ? "Bootloader" : "Interface";
     pos += util_write_string(buf + pos, "Daplink Mode: ");
@@ -292,13 +401,13 @@ static uint32_t read_file_details_txt(uint32_t sector_offset, uint8_t *data, uin
     // CRC of the bootloader (if there is one)
     if (info_get_bootloader_present()) {
         pos += util_write_string(buf + pos, "Bootloader CRC: 0x");
-        pos += util_write_hex32(buf + pos, info_get_crc_bootloader());
+        pos += util_write_hex32(buf + pos, with_crc ? info_get_crc_bootloader() : 0);
         pos += util_write_string(buf + pos, "\r\n");
     }
 
     // CRC of the interface
     pos += util_write_string(buf + pos, "Interface CRC: 0x");
-    pos += util_write_hex32(buf + pos, info_get_crc_interface());
+    pos += util_write_hex32(buf + pos, with_crc ? info_get_crc_interface() : 0);
     pos += util_write_string(buf + pos, "\r\n");
 
     // Number of remounts that have occurred
@@ -379,6 +488,21 @@ static uint32_t read_file_need_bl_txt(uint32_t sector_offset, uint8_t *data, uin
     return size;
 }
 
+// Size of the largest image that can be programmed
+static uint32_t get_image_size(void)
+{
+#if defined(DAPLINK_IF)
+
+    if (target_device.flash_end > target_device.flash_start) {
+        return target_device.flash_end - target_device.flash_start;
+    }
+
+    return 0;
+#else
+    return DAPLINK_ROM_IF_SIZE;
+#endif
+}
+
 // Remove strip_count characters from the start of buf and then insert
 // new_str at the new start of buf.
 static void insert(uint8_t *buf, uint8_t *new_str, uint32_t strip_count)
@@ -464,6 +588,78 @@ static void update_html_file(uint8_t *buf, uint32_t bufsize)
     memset(buf, 0, bufsize - size_left);
 }
 
+#if defined(DAPLINK_IF)
+// Read target memory straight into the USB buffer. The MSC class already
+// asks for USBD_MSC_BlockGroup sectors at a time, so every call moves a
+// whole group over SWD with auto-increment and no extra copy. The target
+// stays connected until the reads stop for TARGET_READ_IDLE_MS.
+static uint32_t read_target_memory(uint32_t addr, uint32_t end, uint8_t *data, uint32_t num_sectors)
+{
+    uint32_t size = num_sectors * VFS_SECTOR_SIZE;
+
+    if (addr >= end) {
+        return 0;
+    }
+
+    if (size > end - addr) {
+        size = end - addr;
+    }
+
+    // Read blank while the target is being programmed or a debugger is
+    // connected. Either one takes over the port, so a connection kept
+    // from earlier reads is gone too. The DAP task runs commands under
+    // DAP_Lock, so no DAP_Connect can start until the read is done.
+    DAP_Lock();
+
+    if (!flash_manager_claim()) {
+        target_read_connected = false;
+        DAP_Unlock();
+        return 0;
+    }
+
+    if (DAP_Data.debug_port != DAP_PORT_DISABLED) {
+        target_read_connected = false;
+        flash_manager_release();
+        DAP_Unlock();
+        return 0;
+    }
+
+    target_read_idle_ms = 0;
+
+    // Connect again if the kept connection no longer works, the target
+    // may have been reset since the last read
+    if (!target_read_connected || !swd_read_memory(addr, data, size)) {
+        swd_select_target(target_device.swd_targetsel);
+        target_read_connected = swd_init_debug();
+
+        if (!target_read_connected || !swd_read_memory(addr, data, size)) {
+            target_read_connected = false;
+            swd_off();
+            memset(data, 0, size);
+            size = 0;
+        }
+    }
+
+    flash_manager_release();
+    DAP_Unlock();
+    return size;
+}
+
+// File callback to be used with vfs_add_file to return file contents
+static uint32_t read_file_flash_bin(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors)
+{
+    return read_target_memory(target_device.flash_start + sector_offset * VFS_SECTOR_SIZE,
+                              target_device.flash_end, data, num_sectors);
+}
+
+// File callback to be used with vfs_add_file to return file contents
+static uint32_t read_file_ram_bin(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors)
+{
+    return read_target_memory(target_device.ram_start + sector_offset * VFS_SECTOR_SIZE,
+                              target_device.ram_end, data, num_sectors);
+}
+#endif
+
 // Initialize flash algo, erase flash, uninit algo
 static void erase_target(void)
 {
@@ -471,3 +667,21 @@ static void erase_target(void)
     flash_intf_target->erase_chip();
     flash_intf_target->uninit();
 }
+
+#if (DAP_PROFILE != 0)
+// File callback to be used with vfs_add_file to return file contents
+static uint32_t read_file_profile_txt(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors)
+{
+    uint32_t pos;
+
+    if (sector_offset != 0) {
+        return 0;
+    }
+
+    // The counts keep changing after the file size is set at mount time,
+    // so the file always takes a full sector padded with spaces
+    pos = dap_profile_write_text((char *)data, VFS_SECTOR_SIZE);
+    memset(data + pos, ' ', VFS_SECTOR_SIZE - pos);
+    return VFS_SECTOR_SIZE;
+}
+#endif
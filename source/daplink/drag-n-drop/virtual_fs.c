@@ -75,6 +75,9 @@ typedef struct {
 typedef struct file_allocation_table {
     uint8_t f[512];
 } file_allocation_table_t;
+#define FAT_ENTRIES_IN_RAM  (sizeof(file_allocation_table_t) / 2)
+#define FAT_ENTRY_EOC       0xFFF8  // Entries at or above this end a chain
+#define FAT_RUNS            8
 
 typedef struct FatDirectoryEntry {
     vfs_filename_t filename;
@@ -103,18 +106,43 @@ typedef struct virtual_media {
     vfs_read_cb_t read_cb;
     vfs_write_cb_t write_cb;
     uint32_t length;
+    bool uncached;
 } virtual_media_t;
 
+// A stretch of consecutive clusters the host has linked in the FAT
+typedef struct fat_run {
+    uint32_t first;     // First cluster of the run
+    uint32_t last;      // Last cluster of the run written so far
+    uint32_t next;      // Entry of the last cluster, 0 if it points to last + 1
+} fat_run_t;
+
+#if (VFS_CACHE_SECTORS > 0)
+typedef struct sector_cache {
+    uint32_t sector;
+    uint32_t last_use;
+    uint8_t data[VFS_SECTOR_SIZE];
+} sector_cache_t;
+#endif
+
 static uint32_t read_zero(uint32_t offset, uint8_t *data, uint32_t size);
 static void write_none(uint32_t offset, const uint8_t *data, uint32_t size);
 
 static uint32_t read_mbr(uint32_t offset, uint8_t *data, uint32_t size);
 static uint32_t read_fat(uint32_t offset, uint8_t *data, uint32_t size);
+static void write_fat(uint32_t offset, const uint8_t *data, uint32_t size);
 static uint32_t read_dir(uint32_t offset, uint8_t *data, uint32_t size);
 static void write_dir(uint32_t offset, const uint8_t *data, uint32_t size);
 static void file_change_cb_stub(const vfs_filename_t filename, vfs_file_change_t change,
                                 vfs_file_t file, vfs_file_t new_file_data);
 static uint32_t cluster_to_sector(uint32_t cluster_idx);
+static uint16_t get_fat_entry(uint32_t idx);
+static fat_run_t *find_fat_run(uint32_t cluster, bool open_end);
+static uint32_t sector_to_cluster(uint32_t sector);
+#if (VFS_CACHE_SECTORS > 0)
+static void cache_clear(void);
+static bool cache_read(uint32_t sector, uint8_t *buf);
+static void cache_write(uint32_t sector, const uint8_t *buf);
+#endif
 static bool filename_valid(const vfs_filename_t filename);
 static bool filename_character_valid(char character);
 static void set_init_done(void);
@@ -129,7 +157,7 @@ static const mbr_t mbr_tmpl = {
         'M', 'S', 'D', '0', 'S', '4', '.', '1' // OEM Name in text (8 chars max)
     },
     /*uint16_t*/.bytes_per_sector           = 0x0200,       // 512 bytes per sector
-    /*uint8_t */.sectors_per_cluster        = 0x08,         // 4k cluser
+    /*uint8_t */.sectors_per_cluster        = 0x08,         // 4k cluster - set at runtime
     /*uint16_t*/.reserved_logical_sectors   = 0x0001,       // mbr is 1 sector
     /*uint8_t */.num_fats                   = 0x02,         // 2 FATs
     /*uint16_t*/.max_root_dir_entries       = 0x0020,       // 32 dir entries (max)
@@ -197,7 +225,7 @@ enum virtual_media_idx_t {
 const virtual_media_t virtual_media_tmpl[] = {
     /*  Read CB         Write CB        Region Size                 Region Name     */
     {   read_mbr,       write_none,     VFS_SECTOR_SIZE         },  /* MBR          */
-    {   read_fat,       write_none,     0 /* Set at runtime */  },  /* FAT1         */
+    {   read_fat,       write_fat,      0 /* Set at runtime */  },  /* FAT1         */
     {   read_fat,       write_none,     0 /* Set at runtime */  },  /* FAT2         */
     {   read_dir,       write_dir,      VFS_SECTOR_SIZE * 2     },  /* Root Dir     */
     /* Raw filesystem contents follow */
@@ -247,11 +275,19 @@ uint32_t fat_idx;
 uint32_t dir_idx;
 uint32_t data_start;
 bool init_complete;
+// Chains written by the host, the FAT itself is too large to keep
+static fat_run_t fat_runs[FAT_RUNS];
+static uint32_t fat_run_replace;
+#if (VFS_CACHE_SECTORS > 0)
+// Hosts read the FAT and the small text files over and over while mounting
+static sector_cache_t sector_cache[VFS_CACHE_SECTORS];
+static uint32_t cache_use_count;
+#endif
 
 // Virtual media must be larger than the template
 COMPILER_ASSERT(sizeof(virtual_media) > sizeof(virtual_media_tmpl));
 
-static void write_fat(file_allocation_table_t *fat, uint32_t idx, uint16_t val)
+static void set_fat_entry(file_allocation_table_t *fat, uint32_t idx, uint16_t val)
 {
     uint32_t low_idx;
     uint32_t high_idx;
@@ -268,7 +304,7 @@ static void write_fat(file_allocation_table_t *fat, uint32_t idx, uint16_t val)
     fat->f[high_idx] = (val >> 8) & 0xFF;
 }
 
-void vfs_init(const vfs_filename_t drive_name, uint32_t disk_size)
+void vfs_init(const vfs_filename_t drive_name, uint32_t disk_size, uint32_t cluster_size)
 {
     uint32_t i;
     uint32_t num_clusters;
@@ -286,12 +322,24 @@ void vfs_init(const vfs_filename_t drive_name, uint32_t disk_size)
     virtual_media_idx = 0;
     data_start = 0;
     init_complete = false;
+    memset(fat_runs, 0, sizeof(fat_runs));
+    fat_run_replace = 0;
+#if (VFS_CACHE_SECTORS > 0)
+    cache_clear();
+#endif
     // Initialize MBR
     memcpy(&mbr, &mbr_tmpl, sizeof(mbr_t));
+    // Larger clusters mean fewer FAT entries for the host to read and
+    // write per file, so the cluster size is picked by the caller
+    mbr.sectors_per_cluster = VFS_CLUSTER_SIZE_MIN / VFS_SECTOR_SIZE;
+    while ((mbr.sectors_per_cluster * VFS_SECTOR_SIZE < cluster_size) &&
+            (mbr.sectors_per_cluster * VFS_SECTOR_SIZE < VFS_CLUSTER_SIZE_MAX)) {
+        mbr.sectors_per_cluster *= 2;
+    }
     total_sectors = ((disk_size + KB(64)) / mbr.bytes_per_sector);
     // Make sure this is the right size for a FAT16 volume
     if (total_sectors < FAT_CLUSTERS_MIN * mbr.sectors_per_cluster) {
-        util_assert(0);
+        // Too few clusters for FAT16, grow the disk
         total_sectors = FAT_CLUSTERS_MIN * mbr.sectors_per_cluster;
     } else if (total_sectors > FAT_CLUSTERS_MAX * mbr.sectors_per_cluster) {
         util_assert(0);
@@ -322,9 +370,9 @@ void vfs_init(const vfs_filename_t drive_name, uint32_t disk_size)
 
     // Initialize FAT
     fat_idx = 0;
-    write_fat(&fat, fat_idx, 0xFFF8);    // Media type "media_descriptor"
+    set_fat_entry(&fat, fat_idx, 0xFFF8);    // Media type "media_descriptor"
     fat_idx++;
-    write_fat(&fat, fat_idx, 0xFFFF);    // FAT12 - always 0xFFF (no meaning), FAT16 - dirty/clean (clean = 0xFFFF)
+    set_fat_entry(&fat, fat_idx, 0xFFFF);    // FAT12 - always 0xFFF (no meaning), FAT16 - dirty/clean (clean = 0xFFFF)
     fat_idx++;
     // Initialize root dir
     dir_idx = 0;
@@ -333,6 +381,11 @@ void vfs_init(const vfs_filename_t drive_name, uint32_t disk_size)
     dir_idx++;
 }
 
+uint32_t vfs_get_cluster_size()
+{
+    return mbr.bytes_per_sector * mbr.sectors_per_cluster;
+}
+
 uint32_t vfs_get_total_size()
 {
     uint32_t size;
@@ -364,12 +417,18 @@ vfs_file_t vfs_create_file(const vfs_filename_t filename, vfs_read_cb_t read_cb,
     if (len > 0) {
         first_cluster = fat_idx;
 
+        // Only the first FAT sector is kept in RAM, the
+        // entries after it are generated by read_fat
         for (i = 0; i < clusters - 1; i++) {
-            write_fat(&fat, fat_idx, fat_idx + 1);
+            if (fat_idx < FAT_ENTRIES_IN_RAM) {
+                set_fat_entry(&fat, fat_idx, fat_idx + 1);
+            }
             fat_idx++;
         }
 
-        write_fat(&fat, fat_idx, 0xFFFF);
+        if (fat_idx < FAT_ENTRIES_IN_RAM) {
+            set_fat_entry(&fat, fat_idx, 0xFFFF);
+        }
         fat_idx++;
     }
 
@@ -416,6 +475,22 @@ void vfs_file_set_attr(vfs_file_t file, vfs_file_attr_bit_t attr)
     de->attributes = attr;
 }
 
+void vfs_file_set_uncached(vfs_file_t file)
+{
+    FatDirectoryEntry_t *de = file;
+    uint32_t idx;
+
+    if ((de <= &dir_current.f[0]) || (de >= &dir_current.f[dir_idx])) {
+        util_assert(0);
+        return;
+    }
+
+    // Files take directory entries and virtual media in the same order,
+    // after the volume label and the filesystem structures
+    idx = (de - &dir_current.f[0]) - 1 + MEDIA_IDX_COUNT;
+    virtual_media[idx].uncached = true;
+}
+
 vfs_sector_t vfs_file_get_start_sector(vfs_file_t file)
 {
     FatDirectoryEntry_t *de = file;
@@ -439,6 +514,84 @@ vfs_file_attr_bit_t vfs_file_get_attr(vfs_file_t file)
     return (vfs_file_attr_bit_t)de->attributes;
 }
 
+uint32_t vfs_get_chain_size(vfs_sector_t start_sector)
+{
+    uint32_t cluster_size = mbr.bytes_per_sector * mbr.sectors_per_cluster;
+    uint32_t cluster = sector_to_cluster(start_sector);
+    uint32_t size = 0;
+    fat_run_t *run;
+    uint32_t i;
+
+    if ((0 == cluster) || (cluster_to_sector(cluster) != start_sector)) {
+        return 0;
+    }
+
+    // A chain has at most one run per tracked entry
+    for (i = 0; i < FAT_RUNS; i++) {
+        run = find_fat_run(cluster, false);
+
+        if ((0 == run) || (run->first != cluster) || (0 == run->next)) {
+            return 0;
+        }
+
+        size += (run->last - run->first + 1) * cluster_size;
+
+        if (run->next >= FAT_ENTRY_EOC) {
+            return size;
+        }
+
+        cluster = run->next;
+    }
+
+    return 0;
+}
+
+uint32_t vfs_get_chain_offset(vfs_sector_t start_sector, vfs_sector_t sector, uint32_t *known_size)
+{
+    uint32_t cluster_size = mbr.bytes_per_sector * mbr.sectors_per_cluster;
+    uint32_t cluster = sector_to_cluster(start_sector);
+    uint32_t target = sector_to_cluster(sector);
+    uint32_t offset = 0;
+    uint32_t sector_offset;
+    fat_run_t *run;
+    uint32_t i;
+
+    *known_size = 0;
+
+    if ((0 == cluster) || (0 == target) || (cluster_to_sector(cluster) != start_sector)) {
+        return VFS_INVALID_OFFSET;
+    }
+
+    sector_offset = (sector - cluster_to_sector(target)) * mbr.bytes_per_sector;
+
+    for (i = 0; i <= FAT_RUNS; i++) {
+        run = find_fat_run(cluster, false);
+
+        // Only the cluster reached so far is known to be in the chain
+        if ((0 == run) || (run->first != cluster)) {
+            *known_size = offset + cluster_size;
+            return (target == cluster) ? offset + sector_offset : VFS_INVALID_OFFSET;
+        }
+
+        if ((target >= run->first) && (target <= run->last)) {
+            *known_size = offset + (run->last - run->first + 1) * cluster_size;
+            return offset + (target - run->first) * cluster_size + sector_offset;
+        }
+
+        offset += (run->last - run->first + 1) * cluster_size;
+
+        if (run->next >= FAT_ENTRY_EOC) {
+            *known_size = offset;
+            return VFS_INVALID_OFFSET;
+        }
+
+        cluster = (0 == run->next) ? run->last + 1 : run->next;
+    }
+
+    *known_size = offset;
+    return VFS_INVALID_OFFSET;
+}
+
 void vfs_set_file_change_callback(vfs_file_change_cb_t cb)
 {
     file_change_cb = cb;
@@ -448,12 +601,26 @@ void vfs_read(uint32_t requested_sector, uint8_t *buf, uint32_t num_sectors)
 {
     uint8_t i = 0;
     uint32_t current_sector;
+
+    set_init_done();
+
+#if (VFS_CACHE_SECTORS > 0)
+    // Serve the leading sectors from the cache
+    while ((num_sectors > 0) && cache_read(requested_sector, buf)) {
+        requested_sector++;
+        buf += VFS_SECTOR_SIZE;
+        num_sectors--;
+    }
+
+    if (num_sectors == 0) {
+        return;
+    }
+#endif
+
     // Zero out the buffer
     memset(buf, 0, num_sectors * VFS_SECTOR_SIZE);
     current_sector = 0;
 
-    set_init_done();
-
     for (i = 0; i < ELEMENTS_IN_ARRAY(virtual_media); i++) {
         uint32_t vm_sectors = virtual_media[i].length / VFS_SECTOR_SIZE;
         uint32_t vm_start = current_sector;
@@ -466,8 +633,18 @@ void vfs_read(uint32_t requested_sector, uint8_t *buf, uint32_t num_sectors)
             sectors_to_write = MIN(sectors_to_write, num_sectors);
             sector_offset = requested_sector - current_sector;
             virtual_media[i].read_cb(sector_offset, buf, sectors_to_write);
+#if (VFS_CACHE_SECTORS > 0)
+            if (!virtual_media[i].uncached) {
+                uint32_t j;
+
+                for (j = 0; j < sectors_to_write; j++) {
+                    cache_write(requested_sector + j, buf + j * VFS_SECTOR_SIZE);
+                }
+            }
+#endif
             // Update requested sector
             requested_sector += sectors_to_write;
+            buf += sectors_to_write * VFS_SECTOR_SIZE;
             num_sectors -= sectors_to_write;
         }
 
@@ -489,6 +666,11 @@ void vfs_write(uint32_t requested_sector, const uint8_t *buf, uint32_t num_secto
 
     set_init_done();
 
+#if (VFS_CACHE_SECTORS > 0)
+    // Writes can change what the file callbacks return
+    cache_clear();
+#endif
+
     for (i = 0; i < virtual_media_idx; i++) {
         uint32_t vm_sectors = virtual_media[i].length / VFS_SECTOR_SIZE;
         uint32_t vm_start = current_sector;
@@ -503,6 +685,7 @@ void vfs_write(uint32_t requested_sector, const uint8_t *buf, uint32_t num_secto
             virtual_media[i].write_cb(sector_offset, buf, sectors_to_read);
             // Update requested sector
             requested_sector += sectors_to_read;
+            buf += sectors_to_read * VFS_SECTOR_SIZE;
             num_sectors -= sectors_to_read;
         }
 
@@ -516,6 +699,57 @@ void vfs_write(uint32_t requested_sector, const uint8_t *buf, uint32_t num_secto
     }
 }
 
+#if (VFS_CACHE_SECTORS > 0)
+static void cache_clear(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < VFS_CACHE_SECTORS; i++) {
+        sector_cache[i].sector = VFS_INVALID_SECTOR;
+        sector_cache[i].last_use = 0;
+    }
+
+    cache_use_count = 0;
+}
+
+static bool cache_read(uint32_t sector, uint8_t *buf)
+{
+    uint32_t i;
+
+    for (i = 0; i < VFS_CACHE_SECTORS; i++) {
+        if (sector_cache[i].sector == sector) {
+            sector_cache[i].last_use = ++cache_use_count;
+            memcpy(buf, sector_cache[i].data, VFS_SECTOR_SIZE);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Replace the least recently used sector
+static void cache_write(uint32_t sector, const uint8_t *buf)
+{
+    uint32_t i;
+    uint32_t oldest = 0;
+
+    for (i = 0; i < VFS_CACHE_SECTORS; i++) {
+        if (sector_cache[i].sector == sector) {
+            oldest = i;
+            break;
+        }
+
+        if (sector_cache[i].last_use < sector_cache[oldest].last_use) {
+            oldest = i;
+        }
+    }
+
+    sector_cache[oldest].sector = sector;
+    sector_cache[oldest].last_use = ++cache_use_count;
+    memcpy(sector_cache[oldest].data, buf, VFS_SECTOR_SIZE);
+}
+#endif
+
 static uint32_t read_zero(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors)
 {
     uint32_t read_size = VFS_SECTOR_SIZE * num_sectors;
@@ -546,19 +780,90 @@ static uint32_t read_mbr(uint32_t sector_offset, uint8_t *data, uint32_t num_sec
 
 static uint32_t read_fat(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors)
 {
-    uint32_t read_size = sizeof(file_allocation_table_t);
-    COMPILER_ASSERT(sizeof(file_allocation_table_t) <= VFS_SECTOR_SIZE);
+    uint32_t read_size = 0;
+    uint32_t idx;
+    uint32_t i;
+    uint16_t val;
+    COMPILER_ASSERT(sizeof(file_allocation_table_t) == VFS_SECTOR_SIZE);
+
+    if (sector_offset == 0) {
+        memcpy(data, &fat, sizeof(file_allocation_table_t));
+        read_size += VFS_SECTOR_SIZE;
+        data += VFS_SECTOR_SIZE;
+        sector_offset++;
+        num_sectors--;
+    }
 
-    if (sector_offset != 0) {
-        // Don't worry about reading other sectors
-        return 0;
+    // Past the first sector the FAT only holds the chains of large files
+    idx = sector_offset * FAT_ENTRIES_IN_RAM;
+
+    while ((num_sectors > 0) && (idx < fat_idx)) {
+        for (i = 0; i < FAT_ENTRIES_IN_RAM; i++) {
+            val = get_fat_entry(idx + i);
+            data[i * 2 + 0] = (val >> 0) & 0xFF;
+            data[i * 2 + 1] = (val >> 8) & 0xFF;
+        }
+
+        idx += FAT_ENTRIES_IN_RAM;
+        read_size += VFS_SECTOR_SIZE;
+        data += VFS_SECTOR_SIZE;
+        num_sectors--;
     }
 
-    memcpy(data, &fat, read_size);
     return read_size;
 }
 
-/* No need to handle writes to the fat */
+// Record the chains the host links in the first FAT. Entries that match
+// the generated FAT are skipped, so only new allocations are tracked.
+// The second FAT is a copy and is ignored.
+static void write_fat(uint32_t sector_offset, const uint8_t *data, uint32_t num_sectors)
+{
+    uint32_t idx = sector_offset * FAT_ENTRIES_IN_RAM;
+    uint32_t count = num_sectors * FAT_ENTRIES_IN_RAM;
+    fat_run_t *run = 0;
+    uint16_t val;
+    uint32_t i;
+
+    for (i = 0; i < count; i++, idx++) {
+        val = (data[i * 2 + 0] << 0) | (data[i * 2 + 1] << 8);
+
+        if ((idx < 2) || (val == get_fat_entry(idx))) {
+            run = 0;
+            continue;
+        }
+
+        // Freed cluster, forget the chain it was part of
+        if (0 == val) {
+            run = find_fat_run(idx, true);
+
+            if (run != 0) {
+                memset(run, 0, sizeof(*run));
+            }
+
+            run = 0;
+            continue;
+        }
+
+        if (0 == run) {
+            run = find_fat_run(idx, true);
+
+            if (0 == run) {
+                // Replace the oldest run
+                run = &fat_runs[fat_run_replace];
+                fat_run_replace = (fat_run_replace + 1) % FAT_RUNS;
+                run->first = idx;
+            }
+        }
+
+        run->last = idx;
+        run->next = (val == idx + 1) ? 0 : val;
+
+        if (run->next != 0) {
+            // The run ends here
+            run = 0;
+        }
+    }
+}
 
 static uint32_t read_dir(uint32_t sector_offset, uint8_t *data, uint32_t num_sectors)
 {
@@ -639,12 +944,75 @@ static void file_change_cb_stub(const vfs_filename_t filename, vfs_file_change_t
     // Do nothing
 }
 
+// Files are allocated back to back as single cluster chains starting at
+// cluster 2, so any FAT entry follows from the file lengths
+static uint16_t get_fat_entry(uint32_t idx)
+{
+    uint32_t i;
+    uint32_t cluster;
+    uint32_t clusters;
+    uint32_t cluster_size;
+
+    if (idx >= fat_idx) {
+        return 0;
+    }
+
+    cluster_size = mbr.bytes_per_sector * mbr.sectors_per_cluster;
+    cluster = 2;
+
+    for (i = MEDIA_IDX_COUNT; i < virtual_media_idx; i++) {
+        clusters = virtual_media[i].length / cluster_size;
+
+        if (idx < cluster + clusters) {
+            return (idx == cluster + clusters - 1) ? 0xFFFF : idx + 1;
+        }
+
+        cluster += clusters;
+    }
+
+    return 0;
+}
+
+// Find the run holding a cluster. With open_end set an unfinished run
+// also matches the cluster it continues into.
+static fat_run_t *find_fat_run(uint32_t cluster, bool open_end)
+{
+    uint32_t i;
+    fat_run_t *run;
+
+    for (i = 0; i < FAT_RUNS; i++) {
+        run = &fat_runs[i];
+
+        if ((0 == run->first) || (cluster < run->first)) {
+            continue;
+        }
+
+        if ((cluster <= run->last) || (open_end && (0 == run->next) && (cluster == run->last + 1))) {
+            return run;
+        }
+    }
+
+    return 0;
+}
+
 static uint32_t cluster_to_sector(uint32_t cluster_idx)
 {
     uint32_t sectors_before_data = data_start / mbr.bytes_per_sector;
     return sectors_before_data + (cluster_idx - 2) * mbr.sectors_per_cluster;
 }
 
+// Returns 0 for sectors outside of the data region
+static uint32_t sector_to_cluster(uint32_t sector)
+{
+    uint32_t sectors_before_data = data_start / mbr.bytes_per_sector;
+
+    if ((VFS_INVALID_SECTOR == sector) || (sector < sectors_before_data)) {
+        return 0;
+    }
+
+    return (sector - sectors_before_data) / mbr.sectors_per_cluster + 2;
+}
+
 static bool filename_valid(const vfs_filename_t  filename)
 {
     // Information on valid 8.3 filenames can be found in
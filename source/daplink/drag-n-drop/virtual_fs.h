@@ -28,12 +28,20 @@
 extern "C" {
 #endif
 
-#define VFS_CLUSTER_SIZE        0x1000
+// Cluster sizes vfs_init accepts, the size in use is vfs_get_cluster_size
+#define VFS_CLUSTER_SIZE_MIN    0x1000
+#define VFS_CLUSTER_SIZE_MAX    0x8000
 #define VFS_SECTOR_SIZE         512
 #define VFS_INVALID_SECTOR      0xFFFFFFFF
+#define VFS_INVALID_OFFSET      0xFFFFFFFF
 #define VFS_FILE_INVALID        0
 #define VFS_MAX_FILES           16
 
+// Number of sectors kept by the read cache, HICs with spare RAM raise this
+#ifndef VFS_CACHE_SECTORS
+#define VFS_CACHE_SECTORS       0
+#endif
+
 typedef char vfs_filename_t[11];
 
 typedef enum {
@@ -67,12 +75,18 @@ typedef uint32_t (*vfs_read_cb_t)(uint32_t sector_offset, uint8_t *data, uint32_
 typedef void (*vfs_file_change_cb_t)(const vfs_filename_t filename, vfs_file_change_t change,
                                      vfs_file_t file, vfs_file_t new_file_data);
 
-// Initialize the filesystem with the given size and name
-void vfs_init(const vfs_filename_t drive_name, uint32_t disk_size);
+// Initialize the filesystem with the given name, size and cluster size. The
+// cluster size is rounded to a power of 2 in the range VFS_CLUSTER_SIZE_MIN
+// to VFS_CLUSTER_SIZE_MAX and the disk grows to the smallest FAT16 volume
+// with clusters of that size if needed.
+void vfs_init(const vfs_filename_t drive_name, uint32_t disk_size, uint32_t cluster_size);
 
 // Get the total size of the virtual filesystem
 uint32_t vfs_get_total_size(void);
 
+// Get the size of a cluster in bytes
+uint32_t vfs_get_cluster_size(void);
+
 // Add a file to the virtual FS and return a handle to this file.
 // This must be called before vfs_read or vfs_write are called.
 // Adding a new file after vfs_read or vfs_write have been called results in undefined behavior.
@@ -81,6 +95,11 @@ vfs_file_t vfs_create_file(const vfs_filename_t filename, vfs_read_cb_t read_cb,
 // Set the attributes of a file
 void vfs_file_set_attr(vfs_file_t file, vfs_file_attr_bit_t attr);
 
+// Keep the sectors of a file out of the read cache. Files are cached by
+// default, which is only valid when the contents do not change until the
+// next vfs_init.
+void vfs_file_set_uncached(vfs_file_t file);
+
 // Get the starting sector of this file.
 // NOTE - If the file size is 0 there is no starting
 // sector so VFS_INVALID_SECTOR will be returned.
@@ -92,6 +111,16 @@ uint32_t vfs_file_get_size(vfs_file_t file);
 // Get the attributes of a file
 vfs_file_attr_bit_t vfs_file_get_attr(vfs_file_t file);
 
+// Get the size of the cluster chain starting at this sector, as written to
+// the FAT by the host. Returns 0 until the end of the chain has been written.
+uint32_t vfs_get_chain_size(vfs_sector_t start_sector);
+
+// Get the byte offset of a sector within the cluster chain starting at
+// start_sector. Returns VFS_INVALID_OFFSET if the sector is not part of
+// the chain as far as it is known. known_size is set to the number of
+// bytes from the start of the chain the FAT accounts for.
+uint32_t vfs_get_chain_offset(vfs_sector_t start_sector, vfs_sector_t sector, uint32_t *known_size);
+
 // Set the callback when a file is created, deleted or has atributes changed.
 void vfs_set_file_change_callback(vfs_file_change_cb_t cb);
 
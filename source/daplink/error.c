@@ -116,6 +116,14 @@ static const char *const error_message[] = {
     // ERROR_BL_UPDT_BAD_CRC
     "The bootloader CRC did not pass.",
 
+    /* Host flash session */
+
+    // ERROR_TARGET_OUT_OF_BOUNDS
+    "Programming aborted due to an address outside of the target flash.",
+
+    // ERROR_FLASH_BUSY
+    "The flash is already being programmed by another session.",
+
 };
 COMPILER_ASSERT(ERROR_COUNT == ELEMENTS_IN_ARRAY(error_message));
 
@@ -76,6 +76,12 @@ typedef enum {
     ERROR_IAP_NO_INTERCEPT,
     ERROR_BL_UPDT_BAD_CRC,
 
+    /* Host flash session */
+    ERROR_TARGET_OUT_OF_BOUNDS,
+
+    /* Flash manager */
+    ERROR_FLASH_BUSY,
+
     // Add new values here
 
     ERROR_COUNT
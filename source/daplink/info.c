@@ -44,6 +44,13 @@ static uint32_t crc_bootloader;
 static uint32_t crc_interface;
 static uint32_t crc_config_admin;
 static uint32_t crc_config_user;
+// Regions whose CRC above is up to date, CRCs are computed on first use
+static uint32_t crc_valid;
+
+#define CRC_VALID_BOOTLOADER    (1 << 0)
+#define CRC_VALID_INTERFACE     (1 << 1)
+#define CRC_VALID_CONFIG_ADMIN  (1 << 2)
+#define CRC_VALID_CONFIG_USER   (1 << 3)
 
 // Strings
 static char string_unique_id[48 + 1];
@@ -163,7 +170,7 @@ static void setup_string_descriptor()
 
 void info_init(void)
 {
-    info_crc_compute();
+    info_crc_invalidate();
     read_unique_id(host_id);
     setup_basics();
     setup_unique_id();
@@ -235,46 +242,64 @@ bool info_get_config_user_present(void)
 
 uint32_t info_get_crc_bootloader()
 {
+    // The last 4 bytes of an image hold its CRC
+    if (!(crc_valid & CRC_VALID_BOOTLOADER) && (DAPLINK_ROM_BL_SIZE > 0)) {
+        crc_bootloader = crc32((void *)DAPLINK_ROM_BL_START, DAPLINK_ROM_BL_SIZE - 4);
+    }
+
+    crc_valid |= CRC_VALID_BOOTLOADER;
     return crc_bootloader;
 }
 
 uint32_t info_get_crc_interface()
 {
+    if (!(crc_valid & CRC_VALID_INTERFACE) && (DAPLINK_ROM_IF_SIZE > 0)) {
+        crc_interface = crc32((void *)DAPLINK_ROM_IF_START, DAPLINK_ROM_IF_SIZE - 4);
+    }
+
+    crc_valid |= CRC_VALID_INTERFACE;
     return crc_interface;
 }
 
 uint32_t info_get_crc_config_admin()
 {
+    if (!(crc_valid & CRC_VALID_CONFIG_ADMIN) && (DAPLINK_ROM_CONFIG_ADMIN_SIZE > 0)) {
+        crc_config_admin = crc32((void *)DAPLINK_ROM_CONFIG_ADMIN_START, DAPLINK_ROM_CONFIG_ADMIN_SIZE);
+    }
+
+    crc_valid |= CRC_VALID_CONFIG_ADMIN;
     return crc_config_admin;
 }
 
 uint32_t info_get_crc_config_user()
 {
+    if (!(crc_valid & CRC_VALID_CONFIG_USER) && (DAPLINK_ROM_CONFIG_USER_SIZE > 0)) {
+        crc_config_user = crc32((void *)DAPLINK_ROM_CONFIG_USER_START, DAPLINK_ROM_CONFIG_USER_SIZE);
+    }
+
+    crc_valid |= CRC_VALID_CONFIG_USER;
     return crc_config_user;
 }
 
-void info_crc_compute()
+void info_crc_invalidate()
 {
     crc_bootloader = 0;
     crc_interface = 0;
     crc_config_admin = 0;
     crc_config_user = 0;
+    crc_valid = 0;
+}
 
-    // Compute the CRCs of regions that exist
-    if (DAPLINK_ROM_BL_SIZE > 0) {
-        crc_bootloader = crc32((void *)DAPLINK_ROM_BL_START, DAPLINK_ROM_BL_SIZE - 4);
-    }
-
-    if (DAPLINK_ROM_IF_SIZE > 0) {
-        crc_interface = crc32((void *)DAPLINK_ROM_IF_START, DAPLINK_ROM_IF_SIZE - 4);
-    }
-
-    if (DAPLINK_ROM_CONFIG_ADMIN_SIZE > 0) {
-        crc_config_admin = crc32((void *)DAPLINK_ROM_CONFIG_ADMIN_START, DAPLINK_ROM_CONFIG_ADMIN_SIZE);
+void info_crc_set_image(uint32_t start, uint32_t crc)
+{
+    if ((DAPLINK_ROM_BL_SIZE > 0) && (DAPLINK_ROM_BL_START == start)) {
+        crc_bootloader = crc;
+        crc_valid |= CRC_VALID_BOOTLOADER;
     }
 
-    if (DAPLINK_ROM_CONFIG_USER_SIZE > 0) {
-        crc_config_user = crc32((void *)DAPLINK_ROM_CONFIG_USER_START, DAPLINK_ROM_CONFIG_USER_SIZE);
+    if ((DAPLINK_ROM_IF_SIZE > 0) && (DAPLINK_ROM_IF_START == start)) {
+        crc_interface = crc;
+        crc_valid |= CRC_VALID_INTERFACE;
     }
 }
 
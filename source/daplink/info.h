@@ -31,7 +31,11 @@ extern "C" {
 
 void info_init(void);
 void info_set_uuid_target(uint32_t *uuid_data);
-void info_crc_compute(void);
+// Drop the cached region CRCs after flash has changed, they are
+// recomputed the next time they are read
+void info_crc_invalidate(void);
+// Cache the CRC of the image at start when it is already known
+void info_crc_set_image(uint32_t start, uint32_t crc);
 
 
 // Get the 48 digit unique ID as a null terminated string.
@@ -81,9 +81,15 @@ void bootloader_check_and_update(void)
 
     same = memcmp((void*)image_start, image_data, image_size) == 0;
     if (!same) {
+        if (!flash_manager_claim()) {
+            util_assert(0);
+            return;
+        }
+
         flash_manager_set_page_erase(false);
         ret = flash_manager_init(flash_intf_iap_protected);
         if (ret != ERROR_SUCCESS) {
+            flash_manager_release();
             util_assert(0);
             return;
         }
@@ -91,11 +97,13 @@ void bootloader_check_and_update(void)
         ret = flash_manager_data(image_start, (const uint8_t*)image_data, image_size);
         if (ret != ERROR_SUCCESS) {
             flash_manager_uninit();
+            flash_manager_release();
             util_assert(0);
             return;
         }
 
         ret = flash_manager_uninit();
+        flash_manager_release();
         if (ret != ERROR_SUCCESS) {
             util_assert(0);
             return;
@@ -55,6 +55,8 @@
 #define FLAGS_MAIN_HID_SEND     (1 << 10)
 // Used by cdc when an event occurs
 #define FLAGS_MAIN_CDC_EVENT    (1 << 11)
+// Used by swo when trace data is ready to be streamed
+#define FLAGS_MAIN_SWO_EVENT    (1 << 12)
 // Used by msd when flashing a new binary
 #define FLAGS_LED_BLINK_30MS    (1 << 6)
 
@@ -166,6 +168,13 @@ void main_cdc_send_event(void)
     return;
 }
 
+// Start SWO trace streaming (called from interrupt context)
+void main_swo_send_event(void)
+{
+    isr_evt_set(FLAGS_MAIN_SWO_EVENT, main_task_id);
+    return;
+}
+
 void main_usb_set_test_mode(bool enabled)
 {
     usb_test_mode = enabled;
@@ -187,6 +196,7 @@ void HardFault_Handler()
 extern __task void hid_process(void);
 extern void hid_send_packet(void);
 extern void cdc_process_event(void);
+__attribute__((weak)) void swo_process_event(void) {}
 __attribute__((weak)) void prerun_board_config(void) {}
 __attribute__((weak)) void prerun_target_config(void) {}
 
@@ -242,6 +252,7 @@ __task void main_task(void)
                        | FLAGS_MAIN_PROC_USB        // process usb events
                        | FLAGS_MAIN_HID_SEND        // send hid packet
                        | FLAGS_MAIN_CDC_EVENT       // cdc event
+                       | FLAGS_MAIN_SWO_EVENT       // swo event
                        , NO_TIMEOUT);
         // Find out what event happened
         flags = os_evt_get();
@@ -288,6 +299,11 @@ __task void main_task(void)
             cdc_process_event();
         }
 
+        // The 30mS tick flushes trace data that did not fill a whole block
+        if (flags & (FLAGS_MAIN_SWO_EVENT | FLAGS_MAIN_30MS)) {
+            swo_process_event();
+        }
+
         if (flags & FLAGS_MAIN_90MS) {
             // Update USB busy status
             vfs_mngr_periodic(90); // FLAGS_MAIN_90MS
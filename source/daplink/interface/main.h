@@ -53,6 +53,7 @@ void main_powerdown_event(void);
 void main_disable_debug_event(void);
 void main_hid_send_event(void);
 void main_cdc_send_event(void);
+void main_swo_send_event(void);
 void main_msc_disconnect_event(void);
 void main_msc_delay_disconnect_event(void);
 void main_force_msc_disconnect_event(void);
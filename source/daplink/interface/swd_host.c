@@ -76,6 +76,23 @@ typedef struct {
 
 static DAP_STATE dap_state;
 
+// SWD multi-drop (DPv2). Several DPs share the bus and are addressed with a
+// TARGETSEL write after each line reset. The SELECT and CSW caches are kept
+// per target so switching between them only costs the selection sequence.
+#define MULTIDROP_TARGETS   4
+
+typedef struct {
+    uint32_t targetsel;
+    DAP_STATE dap_state;
+} MULTIDROP_TARGET;
+
+static MULTIDROP_TARGET multidrop_targets[MULTIDROP_TARGETS];
+static uint32_t multidrop_next;
+// TARGETSEL of the selected DP, 0 when the bus has a single target
+static uint32_t targetsel_state;
+// Set once TARGETSEL has been written on the bus for targetsel_state
+static uint8_t targetsel_valid;
+
 static uint8_t swd_read_core_register(uint32_t n, uint32_t *val);
 static uint8_t swd_write_core_register(uint32_t n, uint32_t val);
 
@@ -105,6 +122,29 @@ static uint8_t swd_transfer_retry(uint32_t req, uint32_t *data)
 }
 
 
+// Forget the cached SELECT and CSW values of the selected DP. Must be
+// called when something else (e.g. the host through DAP_Transfer) may have
+// written them.
+void swd_invalidate_dap_state(void)
+{
+    dap_state.select = 0xffffffff;
+    dap_state.csw = 0xffffffff;
+}
+
+// Forget the cached values of every DP and the bus selection, used when
+// the connection starts over
+static void swd_invalidate_all_targets(void)
+{
+    uint32_t i;
+
+    swd_invalidate_dap_state();
+
+    for (i = 0; i < MULTIDROP_TARGETS; i++) {
+        multidrop_targets[i].dap_state = dap_state;
+    }
+    targetsel_valid = 0;
+}
+
 uint8_t swd_init(void)
 {
     //TODO - DAP_Setup puts GPIO pins in a hi-z state which can
@@ -750,6 +790,130 @@ static uint8_t swd_read_idcode(uint32_t *id)
 }
 
 
+// Wake a DPv2 target from the dormant state into SWD. Multi-drop targets
+// start out dormant; SWD-to-dormant is sent first so targets already in SWD
+// join the others.
+static uint8_t dormant2SWD()
+{
+    // Selection alert sequence, LSB first
+    static const uint8_t selection_alert[16] = {
+        0x92, 0xF3, 0x09, 0x62, 0x95, 0x2D, 0x85, 0x86,
+        0xE9, 0xAF, 0xDD, 0xE3, 0xA2, 0x0E, 0xBC, 0x19,
+    };
+    uint8_t tmp_in[1];
+
+    if (!swd_reset()) {
+        return 0;
+    }
+
+    if (!swd_switch(0xE3BC)) {      // SWD to dormant
+        return 0;
+    }
+
+    tmp_in[0] = 0xff;               // At least 8 cycles high
+    SWJ_Sequence(8, tmp_in);
+    SWJ_Sequence(128, selection_alert);
+    tmp_in[0] = 0x00;               // 4 cycles low
+    SWJ_Sequence(4, tmp_in);
+    tmp_in[0] = 0x1A;               // SWD activation code
+    SWJ_Sequence(8, tmp_in);
+    return 1;
+}
+
+// Write TARGETSEL and read IDCODE to select one DP on a multi-drop bus.
+// Must directly follow a line reset. None of the DPs drives the ACK of a
+// TARGETSEL write, so the whole packet is clocked out as a sequence.
+static uint8_t swd_write_targetsel(uint32_t targetsel)
+{
+    uint8_t tmp_in[6];
+    uint32_t tmp;
+    uint32_t parity;
+    uint32_t i;
+
+    // 2 idle cycles, then start, DP write to A[3:2] = 3, parity 0, stop, park
+    tmp_in[0] = 0x00;
+    SWJ_Sequence(2, tmp_in);
+    tmp_in[0] = 0x99;
+    SWJ_Sequence(8, tmp_in);
+    // Turnaround, ACK and turnaround, nobody answers
+    tmp_in[0] = 0xff;
+    SWJ_Sequence(5, tmp_in);
+
+    parity = 0;
+    for (i = 0; i < 32; i++) {
+        parity ^= (targetsel >> i) & 1;
+    }
+    int2array(tmp_in, targetsel, 4);
+    tmp_in[4] = parity;
+    SWJ_Sequence(33, tmp_in);
+
+    // The selected DP only answers once IDCODE has been read
+    return swd_read_idcode(&tmp);
+}
+
+// Select the DP addressed by targetsel on a multi-drop bus, or go back to a
+// single target bus with targetsel 0. If another DP of the bus is selected
+// the new one is selected right away, otherwise on the next
+// swd_init_debug(). Returns 0 if the DP did not answer.
+uint8_t swd_select_target(uint32_t targetsel)
+{
+    uint32_t i;
+    uint8_t bus_up = targetsel_valid;
+
+    if (targetsel_valid && (targetsel == targetsel_state)) {
+        return 1;
+    }
+
+    // Keep the cache of the DP being left
+    for (i = 0; i < MULTIDROP_TARGETS; i++) {
+        if ((targetsel_state != 0) && (multidrop_targets[i].targetsel == targetsel_state)) {
+            multidrop_targets[i].dap_state = dap_state;
+        }
+    }
+
+    dap_state.select = 0xffffffff;
+    dap_state.csw = 0xffffffff;
+    targetsel_state = targetsel;
+    targetsel_valid = 0;
+
+    if (targetsel == 0) {
+        return 1;
+    }
+
+    // Restore the cache of the new DP or give it the oldest slot
+    for (i = 0; i < MULTIDROP_TARGETS; i++) {
+        if (multidrop_targets[i].targetsel == targetsel) {
+            dap_state = multidrop_targets[i].dap_state;
+            break;
+        }
+    }
+
+    if (i == MULTIDROP_TARGETS) {
+        multidrop_targets[multidrop_next].targetsel = targetsel;
+        multidrop_targets[multidrop_next].dap_state = dap_state;
+        multidrop_next = (multidrop_next + 1) % MULTIDROP_TARGETS;
+    }
+
+    // The DPs have to be woken first, swd_init_debug() does that
+    if (!bus_up) {
+        return 1;
+    }
+
+    if (!swd_reset()) {
+        return 0;
+    }
+
+    if (!swd_write_targetsel(targetsel)) {
+        // The bus is not up yet or the DP is not there, start over in swd_init_debug
+        dap_state.select = 0xffffffff;
+        dap_state.csw = 0xffffffff;
+        return 0;
+    }
+
+    targetsel_valid = 1;
+    return 1;
+}
+
 static uint8_t JTAG2SWD()
 {
     uint32_t tmp = 0;
@@ -779,15 +943,20 @@ uint8_t swd_init_debug(void)
     int i = 0;
     int timeout = 100;
     // init dap state with fake values
-    dap_state.select = 0xffffffff;
-    dap_state.csw = 0xffffffff;
+    swd_invalidate_all_targets();
     swd_init();
     // call a target dependant function
     // this function can do several stuff before really
     // initing the debug
     target_before_init_debug();
 
-    if (!JTAG2SWD()) {
+    if (targetsel_state != 0) {
+        if (!dormant2SWD() || !swd_reset() || !swd_write_targetsel(targetsel_state)) {
+            return 0;
+        }
+
+        targetsel_valid = 1;
+    } else if (!JTAG2SWD()) {
         return 0;
     }
 
@@ -800,6 +969,19 @@ uint8_t swd_init_debug(void)
         return 0;
     }
 
+    // A DP on a multi-drop bus that was already powered up while another
+    // one was selected does not need the power-up handshake again
+    if (targetsel_state != 0) {
+        if (!swd_read_dp(DP_CTRL_STAT, &tmp)) {
+            return 0;
+        }
+
+        if ((tmp & (CDBGPWRUPACK | CSYSPWRUPACK)) == (CDBGPWRUPACK | CSYSPWRUPACK)) {
+            target_unlock_sequence();
+            return swd_write_dp(DP_SELECT, 0);
+        }
+    }
+
     // Power up
     if (!swd_write_dp(DP_CTRL_STAT, CSYSPWRUPREQ | CDBGPWRUPREQ)) {
         return 0;
@@ -122,6 +122,23 @@ uint8_t swd_off(void)
     return 1;
 }
 
+// Forget the cached SELECT and CSW values. Must be called when something
+// else (e.g. the host through DAP_Transfer) may have written them.
+void swd_invalidate_dap_state(void)
+{
+    dap_state.select = 0xffffffff;
+    dap_state.csw = 0xffffffff;
+    // Force the next swd_ca_select_state() to write SELECT again
+    select_state = 0xffffffff;
+}
+
+// Multi-drop buses are not supported here, only the single target
+// (targetsel 0) can be selected
+uint8_t swd_select_target(uint32_t targetsel)
+{
+    return targetsel == 0;
+}
+
 // Read debug port register.
 uint8_t swd_read_dp(uint8_t adr, uint32_t *val)
 {
@@ -302,6 +319,59 @@ static uint8_t swd_write_block(uint32_t address, uint8_t *data, uint32_t size)
     return (ack == 0x01);
 }
 
+// Read 32-bit word aligned values from target memory using address auto-increment.
+// size is in bytes.
+static uint8_t swd_read_block(uint32_t address, uint8_t *data, uint32_t size)
+{
+    uint8_t tmp_in[4], req, ack;
+    uint32_t size_in_words;
+    uint32_t i;
+
+    if (size == 0) {
+        return 0;
+    }
+
+    size_in_words = size / 4;
+
+    // CSW register
+    if (!swd_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE32)) {
+        return 0;
+    }
+
+    if (swd_ca_select_state(address) == 0) {
+        return 0;
+    }
+
+    // TAR write
+    req = SWD_REG_AP | SWD_REG_W | (1 << 2);
+    int2array(tmp_in, address, 4);
+
+    if (swd_transfer_retry(req, (uint32_t *)tmp_in) != 0x01) {
+        return 0;
+    }
+
+    // DRW read
+    req = SWD_REG_AP | SWD_REG_R | (3 << 2);
+
+    // initiate first read, data comes back in next read
+    if (swd_transfer_retry(req, NULL) != 0x01) {
+        return 0;
+    }
+
+    for (i = 0; i < (size_in_words - 1); i++) {
+        if (swd_transfer_retry(req, (uint32_t *)data) != 0x01) {
+            return 0;
+        }
+
+        data += 4;
+    }
+
+    // read last word
+    req = SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_RDBUFF);
+    ack = swd_transfer_retry(req, (uint32_t *)data);
+    return (ack == 0x01);
+}
+
 // Read target memory.
 static uint8_t swd_read_data(uint32_t addr, uint32_t *val)
 {
@@ -384,6 +454,23 @@ static uint8_t swd_read_word(uint32_t addr, uint32_t *val)
     return 1;
 }
 
+// Read 8-bit byte from target memory.
+static uint8_t swd_read_byte(uint32_t addr, uint8_t *val)
+{
+    uint32_t tmp;
+
+    if (!swd_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE8)) {
+        return 0;
+    }
+
+    if (!swd_read_data(addr, &tmp)) {
+        return 0;
+    }
+
+    *val = (uint8_t)(tmp >> ((addr & 0x03) << 3));
+    return 1;
+}
+
 // Write 32-bit word to target memory.
 static uint8_t swd_write_word(uint32_t addr, uint32_t val)
 {
@@ -402,19 +489,50 @@ static uint8_t swd_write_word(uint32_t addr, uint32_t val)
 // size is in bytes.
 uint8_t swd_read_memory(uint32_t address, uint8_t *data, uint32_t size)
 {
-    uint32_t read_size;
-    uint32_t* read_data;
+    uint32_t n;
 
-    read_size = (size / 4);
-    read_data = (uint32_t*)data;
-    /* Write bytes until end */
-    while ((read_size > 0)) {
-        if (!swd_read_data(address, read_data)) {
+    // Read bytes until word aligned
+    while ((size > 0) && (address & 0x3)) {
+        if (!swd_read_byte(address, data)) {
             return 0;
         }
-        address+=4;
-        read_data++;
-        read_size--;
+
+        address++;
+        data++;
+        size--;
+    }
+
+    // Read word aligned blocks
+    while (size > 3) {
+        // Limit to auto increment page size
+        n = TARGET_AUTO_INCREMENT_PAGE_SIZE - (address & (TARGET_AUTO_INCREMENT_PAGE_SIZE - 1));
+        if (size < n) {
+            n = size & 0xFFFFFFFC; // Only count complete words remaining
+        }
+
+        if (!swd_read_block(address, data, n)) {
+            return 0;
+        }
+
+        address += n;
+        data += n;
+        size -= n;
+    }
+
+    // Read remaining bytes
+    while (size > 0) {
+        if (!swd_read_byte(address, data)) {
+            return 0;
+        }
+
+        address++;
+        data++;
+        size--;
+    }
+
+    /* Return the CSW reg value to SIZE8 */
+    if (!swd_write_ap(AP_CSW, CSW_VALUE | CSW_SIZE8)) {
+        return 0;
     }
 
     return 1;
@@ -56,6 +56,9 @@ static error_t target_flash_init()
 {
     const program_target_t *const flash = target_device.flash_algo;
 
+    // Pick the DP of the target on a multi-drop bus before connecting
+    swd_select_target(target_device.swd_targetsel);
+
     if (0 == target_set_state(RESET_PROGRAM)) {
         return ERROR_RESET;
     }
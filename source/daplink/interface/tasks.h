@@ -37,11 +37,22 @@ extern "C" {
 #define MSC_TASK_PRIORITY           (5)
 #define TIMER_TASK_30_PRIORITY      (TIMER_TASK_PRIORITY)
 
+// The vendor flash commands run the flash algorithm on the DAP task stack.
+// They are compiled in only when DAP_VENDOR_FLASH is set to 1 in the HIC
+// macros, for HICs with the RAM to spare.
+#ifndef DAP_VENDOR_FLASH
+#define DAP_VENDOR_FLASH 0
+#endif
+
 // trouble here is that reset for different targets is implemented differently so all targets
 //  have to use the largest stack or these have to be defined in multiple places... Not ideal
 //  may want to move away from threads for some of these behaviours to optimize mempory usage (RAM)
 #define TIMER_TASK_30_STACK (136)
+#if (DAP_VENDOR_FLASH)
+#define DAP_TASK_STACK      (512)   // Room for the flash algorithm calls of the vendor flash commands
+#else
 #define DAP_TASK_STACK      (272)
+#endif
 #define MAIN_TASK_STACK     (800)
 
 #ifdef __cplusplus
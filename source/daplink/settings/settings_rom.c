@@ -20,16 +20,39 @@
  */
 
 #include "string.h"
+#include "stddef.h"
 
 #include "settings.h"
 #include "target_config.h"
 #include "compiler.h"
 #include "cortex_m.h"
+#include "daplink.h"
 #include "FlashPrg.h"
 
 // 'kvld' in hex - key valid
 #define CFG_KEY             0x6b766c64
+// 'kcmt' in hex - record committed
+#define CFG_COMMIT          0x6b636d74
 #define SECTOR_BUFFER_SIZE  16
+// Value of a record key in erased flash
+#define CFG_KEY_ERASED      0xFFFFFFFF
+
+// Settings are stored as a log of records in the user config region. A
+// change appends a record in the next erased slot and the newest valid
+// record wins, so the region is only erased once every slot has been used.
+//
+// Each record ends with a commit word in the last word of the programmed
+// buffer. Flash is programmed in ascending order, so a write torn after
+// the key leaves the commit word erased and the record is skipped.
+//
+// The first slot has the same layout and location as older firmware and
+// generate_config.py use. Older firmware, such as a bootloader that was
+// not updated, only reads that slot. It sees the first record written
+// since the log last wrapped, not later changes.
+#define CFG_RECORD_SIZE     DAPLINK_MIN_WRITE_SIZE
+#define CFG_LOG_SIZE        DAPLINK_ROM_CONFIG_USER_SIZE
+#define CFG_RECORD_COUNT    (CFG_LOG_SIZE / CFG_RECORD_SIZE)
+#define CFG_COMMIT_OFFSET   (SECTOR_BUFFER_SIZE - 4)
 
 // WARNING - THIS STRUCTURE RESIDES IN NON-VOLATILE STORAGE!
 // Be careful with changes:
@@ -44,48 +67,156 @@ typedef struct __attribute__((__packed__)) cfg_setting {
     uint8_t auto_rst;
     uint8_t automation_allowed;
     uint8_t overflow_detect;
+    uint8_t remount_in_place;
+    uint8_t memory_files;
 
     // Add new members here
 
 } cfg_setting_t;
 
 // Make sure FORMAT in generate_config.py is updated if size changes
-COMPILER_ASSERT(sizeof(cfg_setting_t) == 9);
+COMPILER_ASSERT(sizeof(cfg_setting_t) == 11);
 
 // Sector buffer must be as big or bigger than settings
 COMPILER_ASSERT(sizeof(cfg_setting_t) < SECTOR_BUFFER_SIZE);
+// Settings must end before the commit word
+COMPILER_ASSERT(sizeof(cfg_setting_t) <= CFG_COMMIT_OFFSET);
 // Sector buffer must be a multiple of 4 bytes at least.
 // ProgramPage for some interfaces, like the k20dx, require that
 // the data is a multiple of 4 bytes, otherwise programming will
 // fail.  Assert 8 byte alignement just to be safe.
 COMPILER_ASSERT(SECTOR_BUFFER_SIZE % 8 == 0);
+// Each record must fit in its own slot and the log in the config region
+COMPILER_ASSERT(SECTOR_BUFFER_SIZE <= CFG_RECORD_SIZE);
+COMPILER_ASSERT(CFG_RECORD_COUNT >= 1);
+COMPILER_ASSERT(CFG_LOG_SIZE % DAPLINK_SECTOR_SIZE == 0);
 
 // Configuration ROM
-static volatile const cfg_setting_t config_rom __attribute__((section("cfgrom"), zero_init));
+static volatile const uint8_t config_rom[CFG_LOG_SIZE] __attribute__((section("cfgrom"), zero_init));
 // Ram copy of ROM config
 static cfg_setting_t config_rom_copy;
+// Index of the newest valid record, -1 if there is none
+static int32_t config_newest;
+// Index of the first erased slot, CFG_RECORD_COUNT if the log is full
+static uint32_t config_free;
 
 // Configuration defaults in flash
 static const cfg_setting_t config_default = {
     .auto_rst = 0,
     .automation_allowed = 0,
     .overflow_detect = 0,
+    .remount_in_place = 0,
+    .memory_files = 0,
 };
 
 // Buffer for data to flash
 static uint32_t write_buffer[SECTOR_BUFFER_SIZE / 4];
 
+static volatile const cfg_setting_t *config_record(uint32_t index)
+{
+    return (volatile const cfg_setting_t *)&config_rom[index * CFG_RECORD_SIZE];
+}
+
+static uint32_t config_commit(uint32_t index)
+{
+    return *(volatile const uint32_t *)&config_rom[index * CFG_RECORD_SIZE + CFG_COMMIT_OFFSET];
+}
+
+// Records from older firmware and generate_config.py have no commit word.
+// One is only accepted in the first slot, with a plausible size and every
+// setting programmed.
+static bool config_legacy_valid(uint32_t index)
+{
+    volatile const cfg_setting_t *record = config_record(index);
+    uint32_t i;
+
+    if ((index != 0) || (record->size <= offsetof(cfg_setting_t, auto_rst)) ||
+            (record->size > sizeof(cfg_setting_t))) {
+        return false;
+    }
+
+    for (i = offsetof(cfg_setting_t, auto_rst); i < record->size; i++) {
+        if (config_rom[i] > 1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Find the newest record and the end of the log
+static void config_scan(void)
+{
+    uint32_t i;
+    uint32_t key;
+    config_newest = -1;
+
+    for (i = 0; i < CFG_RECORD_COUNT; i++) {
+        key = config_record(i)->key;
+
+        if (CFG_KEY_ERASED == key) {
+            break;
+        }
+
+        // Slots that were not fully programmed are skipped
+        if ((CFG_KEY == key) && ((CFG_COMMIT == config_commit(i)) || config_legacy_valid(i))) {
+            config_newest = i;
+        }
+    }
+
+    config_free = i;
+}
+
+static bool config_sector_blank(uint32_t addr)
+{
+    uint32_t i;
+
+    for (i = 0; i < DAPLINK_SECTOR_SIZE; i += 4) {
+        if (*(volatile const uint32_t *)(addr + i) != CFG_KEY_ERASED) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Erase the log sector by sector. EraseSector can erase more than
+// DAPLINK_SECTOR_SIZE, like the 4KB sectors of the lpc11u35, so sectors
+// that are already blank are skipped.
+static uint32_t config_erase(void)
+{
+    uint32_t addr;
+    uint32_t status;
+    cortex_int_state_t state;
+
+    for (addr = (uint32_t)config_rom; addr < (uint32_t)config_rom + CFG_LOG_SIZE; addr += DAPLINK_SECTOR_SIZE) {
+        if (config_sector_blank(addr)) {
+            continue;
+        }
+
+        state = cortex_int_get_and_disable();
+        status = EraseSector(addr);
+        cortex_int_restore(state);
+
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    return 0;
+}
+
 // Check if the configuration in flash needs to be updated
 static bool config_needs_update()
 {
-    // Update if the key is invalid
-    if (CFG_KEY != config_rom.key) {
+    // Update if there is no valid record
+    if (config_newest < 0) {
         return true;
     }
 
     // Update if the config key is valid but
     // has a smaller size.
-    if (config_rom.size < sizeof(config_rom)) {
+    if (config_record(config_newest)->size < sizeof(cfg_setting_t)) {
         return true;
     }
 
@@ -97,27 +228,35 @@ static bool config_needs_update()
 // Reprogram the new settings if flash writing is allowed
 static void program_cfg(cfg_setting_t *new_cfg)
 {
-    uint32_t status;
     uint32_t addr;
     cortex_int_state_t state;
-    addr = (uint32_t)&config_rom;
-    state = cortex_int_get_and_disable();
-    status = EraseSector(addr);
-    cortex_int_restore(state);
 
-    if (status != 0) {
+    // Nothing to do if the newest record already holds these settings
+    if ((config_newest >= 0) &&
+            (0 == memcmp((void *)config_record(config_newest), new_cfg, sizeof(cfg_setting_t)))) {
         return;
     }
 
+    // Start the log over once every slot has been used
+    if (config_free >= CFG_RECORD_COUNT) {
+        if (config_erase() != 0) {
+            return;
+        }
+
+        config_newest = -1;
+        config_free = 0;
+    }
+
+    addr = (uint32_t)config_record(config_free);
     memset(write_buffer, 0xFF, sizeof(write_buffer));
     memcpy(write_buffer, new_cfg, sizeof(cfg_setting_t));
+    write_buffer[CFG_COMMIT_OFFSET / 4] = CFG_COMMIT;
     state = cortex_int_get_and_disable();
-    status = ProgramPage(addr, sizeof(write_buffer), write_buffer);
+    ProgramPage(addr, sizeof(write_buffer), write_buffer);
     cortex_int_restore(state);
 
-    if (0 != status) {
-        return;
-    }
+    // Rescan so a failed write leaves the slot marked as used
+    config_scan();
 }
 
 void config_rom_init()
@@ -126,15 +265,18 @@ void config_rom_init()
     // Fill in the ram copy with the defaults
     memcpy(&config_rom_copy, &config_default, sizeof(config_rom_copy));
 
-    // Read settings from flash if the key is valid
-    if (CFG_KEY == config_rom.key) {
-        uint32_t size = MIN(config_rom.size, sizeof(config_rom));
-        memcpy(&config_rom_copy, (void *)&config_rom, size);
+    // Read settings from the newest valid record in flash
+    config_scan();
+
+    if (config_newest >= 0) {
+        volatile const cfg_setting_t *record = config_record(config_newest);
+        uint32_t size = MIN(record->size, sizeof(cfg_setting_t));
+        memcpy(&config_rom_copy, (void *)record, size);
     }
 
     // Fill in special values
     config_rom_copy.key = CFG_KEY;
-    config_rom_copy.size = sizeof(config_rom);
+    config_rom_copy.size = sizeof(cfg_setting_t);
 
     // Write settings back to flash if they are out of date
     // Note - program_cfg only programs data in bootloader mode
@@ -163,6 +305,18 @@ void config_set_overflow_detect(bool on)
     program_cfg(&config_rom_copy);
 }
 
+void config_set_remount_in_place(bool on)
+{
+    config_rom_copy.remount_in_place = on;
+    program_cfg(&config_rom_copy);
+}
+
+void config_set_memory_files(bool on)
+{
+    config_rom_copy.memory_files = on;
+    program_cfg(&config_rom_copy);
+}
+
 bool config_get_auto_rst()
 {
     return config_rom_copy.auto_rst;
@@ -177,3 +331,13 @@ bool config_get_overflow_detect()
 {
     return config_rom_copy.overflow_detect;
 }
+
+bool config_get_remount_in_place(void)
+{
+    return config_rom_copy.remount_in_place;
+}
+
+bool config_get_memory_files(void)
+{
+    return config_rom_copy.memory_files;
+}
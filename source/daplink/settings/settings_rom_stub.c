@@ -43,6 +43,16 @@ void config_set_overflow_detect(bool on)
     // Do nothing
 }
 
+void config_set_remount_in_place(bool on)
+{
+    // Do nothing
+}
+
+void config_set_memory_files(bool on)
+{
+    // Do nothing
+}
+
 bool config_get_auto_rst()
 {
     return false;
@@ -57,3 +67,13 @@ bool config_get_overflow_detect()
 {
     return false;
 }
+
+bool config_get_remount_in_place()
+{
+    return false;
+}
+
+bool config_get_memory_files()
+{
+    return false;
+}
@@ -94,6 +94,10 @@ Provides definitions about:
 /// SWO Trace Buffer Size.
 #define SWO_BUFFER_SIZE         4096U           ///< SWO Trace Buffer Size in bytes (must be 2^n)
 
+/// Indicate that SWO Streaming Trace is available.
+/// This information is returned by the command \ref DAP_Info as part of <b>Capabilities</b>.
+#define SWO_STREAM              0               ///< SWO Streaming Trace: 1 = available, 0 = not available
+
 
 /// Debug Unit is connected to fixed Target Device.
 /// The Debug Unit may be part of an evaluation board and always connected to a fixed
@@ -0,0 +1,70 @@
+/**
+ * @file    crc32_hal.c
+ * @brief   CRC32 on the CRC peripheral of the K20DX HIC
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MK20D5.h"
+#include "crc.h"
+#include "cortex_m.h"
+
+#if (CRC32_ENGINE == CRC32_ENGINE_HAL)
+
+// Words processed with interrupts disabled. Other tasks can use the
+// peripheral between blocks since it is reseeded for every block.
+#define BLOCK_WORDS     64
+
+uint32_t crc32_hal_update(uint32_t remainder, const void *data, int nBytes)
+{
+    const uint8_t *message = data;
+    cortex_int_state_t state;
+    uint32_t word;
+    int words = nBytes / 4;
+    int count;
+
+    SIM->SCGC6 |= SIM_SCGC6_CRC_MASK;
+
+    while (words > 0) {
+        count = words < BLOCK_WORDS ? words : BLOCK_WORDS;
+        words -= count;
+        state = cortex_int_get_and_disable();
+        // 32-bit CRC with writes and reads fully bit reversed, so the
+        // data register holds the reflected remainder. The seed write
+        // is transposed the same way as data.
+        CRC0->CTRL = CRC_CTRL_TCRC(1) | CRC_CTRL_TOT(2) | CRC_CTRL_TOTR(2);
+        CRC0->GPOLY = 0x04C11DB7;
+        CRC0->CTRL |= CRC_CTRL_WAS_MASK;
+        CRC0->CRC = remainder;
+        CRC0->CTRL &= ~CRC_CTRL_WAS_MASK;
+
+        while (count-- > 0) {
+            // Assembled a byte at a time since data may be unaligned
+            word = (message[0] << 0) | (message[1] << 8) |
+                   (message[2] << 16) | ((uint32_t)message[3] << 24);
+            CRC0->CRC = word;
+            message += 4;
+        }
+
+        remainder = CRC0->CRC;
+        cortex_int_restore(state);
+    }
+
+    return remainder;
+}
+
+#endif
@@ -58,6 +58,10 @@
 #define DAPLINK_RAM_APP2_START          0x20000000
 #define DAPLINK_RAM_APP2_SIZE           0x00000800
 
+/* Upper half of the USB RAM, the endpoint buffers stay in the lower half */
+#define DAPLINK_RAM_APP3_START          0x20004400
+#define DAPLINK_RAM_APP3_SIZE           0x00000400
+
 /* Flash Programming Info */
 
 #define DAPLINK_SECTOR_SIZE             0x00000100
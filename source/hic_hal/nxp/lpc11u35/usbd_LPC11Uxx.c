@@ -24,6 +24,7 @@
 #include "LPC11Uxx.h"
 #include "compiler.h"
 #include "util.h"
+#include "daplink_addr.h"
 
 #define __NO_USB_LIB_C
 #include "usb_config.c"
@@ -305,6 +306,9 @@ void USBD_ConfigEP(USB_ENDPOINT_DESCRIPTOR *pEPD)
 
         addr += ((val + 63) >> 6) * 64;     /* calc new free buffer address */
     }
+
+    /* The rest of the USB RAM holds application data */
+    util_assert(addr <= DAPLINK_RAM_APP3_START);
 }
 
 
@@ -72,6 +72,11 @@
 #define DAPLINK_ROM_UPDATE_START         DAPLINK_ROM_BL_START
 #define DAPLINK_ROM_UPDATE_SIZE          DAPLINK_ROM_BL_SIZE
 
+/* Bootloader updates are staged in 64kB sector 11, above the user config */
+#define DAPLINK_ROM_STAGING_START        0x1A040000
+#define DAPLINK_ROM_STAGING_SIZE         DAPLINK_ROM_BL_SIZE
+#define DAPLINK_ROM_STAGING_SECTOR_SIZE  0x00010000
+
 #else
 
 #error "Build must be either bootloader or interface"
@@ -0,0 +1,234 @@
+/**
+ * @file    uart_swo.c
+ * @brief   SWO capture on UART1 for the LPC4322 HIC
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LPC43xx.h"
+#include "uart_swo.h"
+#include "lpc43xx_cgu.h"
+#include "lpc43xx_scu.h"
+#include "util.h"
+
+// The target SWO pin is routed to P1_14 which can be muxed as U1_RXD.
+// UART1 is otherwise unused; the virtual COM port runs on USART0.
+#define SWO_UART_IRQn       UART1_IRQn
+#define LPC_SWO_UART        LPC_UART1
+#define SWO_UART_IRQHandler UART1_IRQHandler
+
+// LSR bits
+#define LSR_RDR             (1 << 0)
+#define LSR_OE              (1 << 1)
+#define LSR_PE              (1 << 2)
+#define LSR_FE              (1 << 3)
+#define LSR_BI              (1 << 4)
+
+// IER bits
+#define IER_RBR             (1 << 0)
+#define IER_RLS             (1 << 2)
+
+extern uint32_t SystemCoreClock;
+
+static uart_swo_callback_t callback;
+static uint8_t *volatile rx_buf;
+static volatile uint32_t rx_num;
+static volatile uint32_t rx_count;
+// Set on the first byte lost while no buffer is armed so that a paused
+// capture reports a single overflow rather than one per byte
+static volatile bool rx_dropped;
+// Divider currently programmed, 0 when the UART has not been configured
+static uint32_t uart_dl;
+
+static void reset(void);
+
+int32_t uart_swo_initialize(uart_swo_callback_t cb)
+{
+    NVIC_DisableIRQ(SWO_UART_IRQn);
+
+    // The baudrate calculations require the UART to be clocked as SystemCoreClock
+    CGU_EntityConnect(CGU_CLKSRC_PLL1, CGU_BASE_UART1);
+    CGU_EnableEntity(CGU_BASE_UART1, ENABLE);
+    scu_pinmux(1, 14, UART_RX_TX, FUNC1);   /* P1_14: U1_RXD (SWO) */
+
+    callback = cb;
+    // enable FIFOs (trigger level 8) and clear them
+    LPC_SWO_UART->FCR = 0x87;
+    // 8 data bits, no parity, 1 stop bit
+    LPC_SWO_UART->LCR = 0x03;
+    // Receive only
+    LPC_SWO_UART->TER = 0x00;
+    reset();
+    NVIC_EnableIRQ(SWO_UART_IRQn);
+    return 1;
+}
+
+int32_t uart_swo_uninitialize(void)
+{
+    LPC_SWO_UART->IER = 0;
+    NVIC_DisableIRQ(SWO_UART_IRQn);
+    reset();
+    scu_pinmux(1, 14, GPIO_NOPULL, FUNC0);  /* P1_14: GPIO1[7] (input) */
+    CGU_EnableEntity(CGU_BASE_UART1, DISABLE);
+    callback = 0;
+    return 1;
+}
+
+uint32_t uart_swo_set_baudrate(uint32_t baudrate)
+{
+    uint32_t dl;
+
+    if (baudrate == 0) {
+        return 0;
+    }
+
+    // SWO runs at a fixed multiple of the trace clock, so only integer
+    // dividers are used to keep the sample point as close as possible.
+    dl = util_div_round(SystemCoreClock, 16 * baudrate);
+    if ((dl == 0) || (dl > 0xFFFF)) {
+        return 0;
+    }
+
+    if (dl == uart_dl) {
+        return SystemCoreClock / (16 * dl);
+    }
+
+    NVIC_DisableIRQ(SWO_UART_IRQn);
+    // set LCR[DLAB] to enable writing to divider registers
+    LPC_SWO_UART->LCR |= (1 << 7);
+    LPC_SWO_UART->DLM = (dl >> 8) & 0xFF;
+    LPC_SWO_UART->DLL = (dl >> 0) & 0xFF;
+    // DIVADDVAL = 0, MULVAL = 1 (fractional divider bypassed)
+    LPC_SWO_UART->FDR = 1 << 4;
+    // clear LCR[DLAB]
+    LPC_SWO_UART->LCR &= ~(1 << 7);
+    // Data received at the old rate is garbage, start on a clean boundary
+    LPC_SWO_UART->FCR = 0x87;
+    LPC_SWO_UART->LSR;
+    uart_dl = dl;
+    NVIC_EnableIRQ(SWO_UART_IRQn);
+
+    return SystemCoreClock / (16 * dl);
+}
+
+int32_t uart_swo_enable(bool enable)
+{
+    if (enable) {
+        // Discard error flags latched while capture was stopped
+        LPC_SWO_UART->LSR;
+        LPC_SWO_UART->IER = IER_RBR | IER_RLS;
+    } else {
+        LPC_SWO_UART->IER = 0;
+    }
+
+    return 1;
+}
+
+int32_t uart_swo_receive(uint8_t *data, uint32_t num)
+{
+    if ((data == 0) || (num == 0)) {
+        return 0;
+    }
+
+    NVIC_DisableIRQ(SWO_UART_IRQn);
+    rx_count = 0;
+    rx_num = num;
+    rx_buf = data;
+    rx_dropped = false;
+    NVIC_EnableIRQ(SWO_UART_IRQn);
+    return 1;
+}
+
+uint32_t uart_swo_abort_receive(void)
+{
+    uint32_t count;
+
+    NVIC_DisableIRQ(SWO_UART_IRQn);
+    count = rx_count;
+    rx_buf = 0;
+    rx_num = 0;
+    rx_count = 0;
+    NVIC_EnableIRQ(SWO_UART_IRQn);
+    return count;
+}
+
+uint32_t uart_swo_get_rx_count(void)
+{
+    return rx_count;
+}
+
+bool uart_swo_rx_busy(void)
+{
+    return rx_buf != 0;
+}
+
+void SWO_UART_IRQHandler(void)
+{
+    uint32_t lsr;
+    uint32_t event = 0;
+    uint8_t data;
+
+    // reading IIR acknowledges the interrupt
+    LPC_SWO_UART->IIR;
+    lsr = LPC_SWO_UART->LSR;
+
+    if (lsr & LSR_OE) {
+        event |= UART_SWO_EVENT_RX_OVERFLOW;
+    }
+    if (lsr & (LSR_PE | LSR_FE | LSR_BI)) {
+        event |= UART_SWO_EVENT_RX_ERROR;
+    }
+
+    while (lsr & LSR_RDR) {
+        data = LPC_SWO_UART->RBR;
+        if (rx_buf != 0) {
+            rx_buf[rx_count++] = data;
+            if (rx_count == rx_num) {
+                rx_buf = 0;
+                event |= UART_SWO_EVENT_RECEIVE_COMPLETE;
+                // Let the consumer re-arm the next buffer before more data is read
+                break;
+            }
+        } else {
+            // No buffer armed (trace paused), data is lost
+            if (!rx_dropped) {
+                rx_dropped = true;
+                event |= UART_SWO_EVENT_RX_OVERFLOW;
+            }
+        }
+        lsr = LPC_SWO_UART->LSR;
+    }
+
+    if (event && callback) {
+        callback(event);
+    }
+}
+
+static void reset(void)
+{
+    // Reset RX FIFO
+    LPC_SWO_UART->FCR = 0x03;
+    rx_buf = 0;
+    rx_num = 0;
+    rx_count = 0;
+    rx_dropped = false;
+    uart_dl = 0;
+
+    while (LPC_SWO_UART->LSR & LSR_RDR) {
+        LPC_SWO_UART->RBR;    // Dump data from RX FIFO
+    }
+}
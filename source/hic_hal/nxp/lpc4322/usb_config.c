@@ -28,7 +28,7 @@
 
 //   <o0.0> High-speed
 //     <i> Enable high-speed functionality (if device supports it)
-#define USBD_HS_ENABLE              0
+#define USBD_HS_ENABLE              1
 
 //   <h> Device Settings
 //     <i> These settings affect Device Descriptor
@@ -136,14 +136,14 @@
 #define USBD_HID_EP_INTIN_STACK     0
 #define USBD_HID_WMAXPACKETSIZE     64
 #define USBD_HID_BINTERVAL          1
-#define USBD_HID_HS_ENABLE          0
-#define USBD_HID_HS_WMAXPACKETSIZE  64
-#define USBD_HID_HS_BINTERVAL       6
+#define USBD_HID_HS_ENABLE          1
+#define USBD_HID_HS_WMAXPACKETSIZE  1024
+#define USBD_HID_HS_BINTERVAL       1
 #define USBD_HID_STRDESC            L"CMSIS-DAP"
 #define USBD_HID_INREPORT_NUM       1
 #define USBD_HID_OUTREPORT_NUM      1
-#define USBD_HID_INREPORT_MAX_SZ    64
-#define USBD_HID_OUTREPORT_MAX_SZ   64
+#define USBD_HID_INREPORT_MAX_SZ    1024
+#define USBD_HID_OUTREPORT_MAX_SZ   1024
 #define USBD_HID_FEATREPORT_MAX_SZ  1
 
 //     <e0.0> Mass Storage Device (MSC)
@@ -186,7 +186,7 @@
 #define USBD_MSC_EP_BULKOUT         2
 #define USBD_MSC_EP_BULKIN_STACK    0
 #define USBD_MSC_WMAXPACKETSIZE     64
-#define USBD_MSC_HS_ENABLE          0
+#define USBD_MSC_HS_ENABLE          1
 #define USBD_MSC_HS_WMAXPACKETSIZE  512
 #define USBD_MSC_HS_BINTERVAL       0
 #define USBD_MSC_STRDESC            L"USB_MSC"
@@ -313,13 +313,13 @@
 #define USBD_CDC_ACM_EP_BULKOUT         4
 #define USBD_CDC_ACM_EP_BULKIN_STACK    0
 #define USBD_CDC_ACM_WMAXPACKETSIZE1    64
-#define USBD_CDC_ACM_HS_ENABLE1         0
-#define USBD_CDC_ACM_HS_WMAXPACKETSIZE1 64
+#define USBD_CDC_ACM_HS_ENABLE1         1
+#define USBD_CDC_ACM_HS_WMAXPACKETSIZE1 512
 #define USBD_CDC_ACM_HS_BINTERVAL1      0
 #define USBD_CDC_ACM_CIF_STRDESC        L"mbed Serial Port"
 #define USBD_CDC_ACM_DIF_STRDESC        L"mbed Serial Port"
-#define USBD_CDC_ACM_SENDBUF_SIZE       64
-#define USBD_CDC_ACM_RECEIVEBUF_SIZE    64
+#define USBD_CDC_ACM_SENDBUF_SIZE       USBD_CDC_ACM_HS_WMAXPACKETSIZE1
+#define USBD_CDC_ACM_RECEIVEBUF_SIZE    USBD_CDC_ACM_HS_WMAXPACKETSIZE1
 #if (((USBD_CDC_ACM_HS_ENABLE1) && (USBD_CDC_ACM_SENDBUF_SIZE    < USBD_CDC_ACM_HS_WMAXPACKETSIZE1)) || (USBD_CDC_ACM_SENDBUF_SIZE    < USBD_CDC_ACM_WMAXPACKETSIZE1))
 #error "Send Buffer size must be larger or equal to Bulk In maximum packet size!"
 #endif
@@ -327,6 +327,82 @@
 #error "Receive Buffer size must be larger or equal to Bulk Out maximum packet size!"
 #endif
 
+//     <e0> Vendor Specific Bulk Device
+//       <i> Enable vendor specific interface used as the CMSIS-DAP v2 (WinUSB)
+//       <i> transport and, optionally, to stream SWO trace data
+//       <h> Bulk Endpoint Settings
+//         <o1.0..4> Command Bulk Out Endpoint Number         <0=> Not used
+//                                            <1=>   1        <2=>   2 <3=>   3
+//                                            <4=>   4        <5=>   5 <6=>   6 <7=>   7
+//                                            <8=>   8        <9=>   9 <10=> 10 <11=> 11
+//                                            <12=>  12       <13=> 13 <14=> 14 <15=> 15
+//         <o2.0..4> Response Bulk In Endpoint Number         <0=> Not used
+//                                            <1=>   1        <2=>   2 <3=>   3
+//                                            <4=>   4        <5=>   5 <6=>   6 <7=>   7
+//                                            <8=>   8        <9=>   9 <10=> 10 <11=> 11
+//                                            <12=>  12       <13=> 13 <14=> 14 <15=> 15
+//         <o3.0..4> SWO Trace Bulk In Endpoint Number        <0=> Not used
+//                                            <1=>   1        <2=>   2 <3=>   3
+//                                            <4=>   4        <5=>   5 <6=>   6 <7=>   7
+//                                            <8=>   8        <9=>   9 <10=> 10 <11=> 11
+//                                            <12=>  12       <13=> 13 <14=> 14 <15=> 15
+//         <h> Endpoint Settings
+//           <o6> Maximum Packet Size <1-1024>
+//           <e7> High-speed
+//             <i> If high-speed is enabled set endpoint settings for it
+//             <o8> Maximum Packet Size <1-1024>
+//             <o9> Maximum NAK Rate <0-255>
+//           </e7>
+//         </h>
+//       </h>
+//       <h> Vendor Specific Bulk Device Settings
+//         <i> Device specific settings
+//         <o10> Maximum Command Size (in bytes) <1-65535>
+//         <o11> Microsoft OS 2.0 Vendor Request Code <1-255>
+//         <s0.126> Vendor Specific Interface String
+//       </h>
+//     </e>
+#ifndef BULK_ENDPOINT
+#define BULK_ENDPOINT 0
+#else
+#define BULK_ENDPOINT 1
+#endif
+#define USBD_BULK_ENABLE                BULK_ENDPOINT
+// USB0 has six endpoints only and the HID, MSC and CDC interfaces already use
+// four IN endpoints. Endpoint 5 carries the CMSIS-DAP v2 commands or, with
+// SWO_STREAM set to 1 in the project macros, the SWO trace stream. Commands
+// then stay on the HID interface.
+#ifndef SWO_STREAM
+#define SWO_STREAM 0
+#endif
+#if (SWO_STREAM)
+#if (!BULK_ENDPOINT)
+#error "SWO_STREAM needs the vendor specific bulk interface (usb-bulk record)"
+#endif
+#define USBD_BULK_EP_CMDOUT             0
+#define USBD_BULK_EP_CMDIN              0
+#define USBD_BULK_EP_CMDIN_STACK        0
+#define USBD_BULK_EP_SWOIN              5
+#define USBD_BULK_EP_SWOIN_STACK        0
+#else
+#define USBD_BULK_EP_CMDOUT             5
+#define USBD_BULK_EP_CMDIN              5
+#define USBD_BULK_EP_CMDIN_STACK        0
+#define USBD_BULK_EP_SWOIN              0
+#define USBD_BULK_EP_SWOIN_STACK        0
+#endif
+#define USBD_BULK_WMAXPACKETSIZE        64
+#define USBD_BULK_HS_ENABLE             1
+#define USBD_BULK_HS_WMAXPACKETSIZE     512
+#define USBD_BULK_HS_BINTERVAL          0
+#define USBD_BULK_CMD_MAX_SZ            1024
+#define USBD_BULK_MS_VENDOR_CODE        0x01
+#if (SWO_STREAM)
+#define USBD_BULK_STRDESC               L"CMSIS-DAP SWO Trace"
+#else
+#define USBD_BULK_STRDESC               L"CMSIS-DAP v2"
+#endif
+
 //     <e0> Custom Class Device
 //       <i> Enables USB Custom Class Requests
 //       <i> Class IDs:
@@ -351,7 +427,7 @@
 
 /* USB Device Calculations ---------------------------------------------------*/
 
-#define USBD_IF_NUM                (USBD_HID_ENABLE+USBD_MSC_ENABLE+(USBD_ADC_ENABLE*2)+(USBD_CDC_ACM_ENABLE*2)+USBD_CLS_ENABLE)
+#define USBD_IF_NUM                (USBD_HID_ENABLE+USBD_MSC_ENABLE+(USBD_ADC_ENABLE*2)+(USBD_CDC_ACM_ENABLE*2)+USBD_BULK_ENABLE+USBD_CLS_ENABLE)
 #define USBD_MULTI_IF              (USBD_CDC_ACM_ENABLE*(USBD_HID_ENABLE|USBD_MSC_ENABLE|USBD_ADC_ENABLE))
 #define MAX(x, y)                (((x) < (y)) ? (y) : (x))
 #define USBD_EP_NUM_CALC0           MAX((USBD_HID_ENABLE    *(USBD_HID_EP_INTIN     )), (USBD_HID_ENABLE    *(USBD_HID_EP_INTOUT!=0)*(USBD_HID_EP_INTOUT)))
@@ -361,7 +437,10 @@
 #define USBD_EP_NUM_CALC4           MAX(USBD_EP_NUM_CALC0, USBD_EP_NUM_CALC1)
 #define USBD_EP_NUM_CALC5           MAX(USBD_EP_NUM_CALC2, USBD_EP_NUM_CALC3)
 #define USBD_EP_NUM_CALC6           MAX(USBD_EP_NUM_CALC4, USBD_EP_NUM_CALC5)
-#define USBD_EP_NUM                (USBD_EP_NUM_CALC6)
+#define USBD_EP_NUM_CALC7           MAX((USBD_BULK_ENABLE   *(USBD_BULK_EP_CMDOUT   )), (USBD_BULK_ENABLE   *(USBD_BULK_EP_CMDIN)))
+#define USBD_EP_NUM_CALC8           MAX(USBD_EP_NUM_CALC6, USBD_EP_NUM_CALC7)
+#define USBD_EP_NUM_CALC9           MAX(USBD_EP_NUM_CALC8, (USBD_BULK_ENABLE*(USBD_BULK_EP_SWOIN)))
+#define USBD_EP_NUM                (USBD_EP_NUM_CALC9)
 
 #if    (USBD_HID_ENABLE)
 #if    (USBD_MSC_ENABLE)
@@ -422,6 +501,24 @@
 #endif
 #endif
 
+#if    (USBD_BULK_ENABLE)
+#define USBD_BULK_EP_CONFLICT(ep)   ((((USBD_HID_ENABLE)     && (((ep) == USBD_HID_EP_INTIN)       || \
+                                                                ((ep) == USBD_HID_EP_INTOUT)))     || \
+                                     ((USBD_MSC_ENABLE)     && (((ep) == USBD_MSC_EP_BULKIN)      || \
+                                                                ((ep) == USBD_MSC_EP_BULKOUT)))    || \
+                                     ((USBD_ADC_ENABLE)     &&  ((ep) == USBD_ADC_EP_ISOOUT))      || \
+                                     ((USBD_CDC_ACM_ENABLE) && (((ep) == USBD_CDC_ACM_EP_INTIN)   || \
+                                                                ((ep) == USBD_CDC_ACM_EP_BULKIN)  || \
+                                                                ((ep) == USBD_CDC_ACM_EP_BULKOUT)))))
+#if  (((USBD_BULK_EP_CMDOUT != 0) && ((USBD_BULK_EP_CONFLICT(USBD_BULK_EP_CMDOUT)) || \
+                                      (USBD_BULK_EP_CONFLICT(USBD_BULK_EP_CMDIN))))  || \
+      ((USBD_BULK_EP_SWOIN != 0) && ((USBD_BULK_EP_CONFLICT(USBD_BULK_EP_SWOIN)) || \
+                                     (USBD_BULK_EP_SWOIN == USBD_BULK_EP_CMDIN)  || \
+                                     (USBD_BULK_EP_SWOIN == USBD_BULK_EP_CMDOUT))))
+#error "Vendor Specific Bulk Interface can not use same Endpoints as other Interfaces!"
+#endif
+#endif
+
 #define USBD_ADC_CIF_NUM           (0)
 #define USBD_ADC_SIF1_NUM          (1)
 #define USBD_ADC_SIF2_NUM          (2)
@@ -429,6 +526,7 @@
 #define USBD_CDC_ACM_CIF_NUM       (USBD_ADC_ENABLE*2+USBD_MSC_ENABLE*1+0)
 #define USBD_CDC_ACM_DIF_NUM       (USBD_ADC_ENABLE*2+USBD_MSC_ENABLE*1+1)
 #define USBD_HID_IF_NUM            (USBD_ADC_ENABLE*2+USBD_MSC_ENABLE*1+USBD_CDC_ACM_ENABLE*2+0)
+#define USBD_BULK_IF_NUM           (USBD_ADC_ENABLE*2+USBD_MSC_ENABLE*1+USBD_CDC_ACM_ENABLE*2+USBD_HID_ENABLE*1+0)
 
 #define USBD_ADC_CIF_STR_NUM       (3+USBD_STRDESC_SER_ENABLE+0)
 #define USBD_ADC_SIF1_STR_NUM      (3+USBD_STRDESC_SER_ENABLE+1)
@@ -437,6 +535,7 @@
 #define USBD_CDC_ACM_DIF_STR_NUM   (3+USBD_STRDESC_SER_ENABLE+USBD_ADC_ENABLE*3+1)
 #define USBD_HID_IF_STR_NUM        (3+USBD_STRDESC_SER_ENABLE+USBD_ADC_ENABLE*3+USBD_CDC_ACM_ENABLE*2)
 #define USBD_MSC_IF_STR_NUM        (3+USBD_STRDESC_SER_ENABLE+USBD_ADC_ENABLE*3+USBD_CDC_ACM_ENABLE*2+USBD_HID_ENABLE)
+#define USBD_BULK_IF_STR_NUM       (3+USBD_STRDESC_SER_ENABLE+USBD_ADC_ENABLE*3+USBD_CDC_ACM_ENABLE*2+USBD_HID_ENABLE+USBD_MSC_ENABLE)
 
 #if    (USBD_HID_ENABLE)
 #if    (USBD_HID_HS_ENABLE)
@@ -480,10 +579,20 @@
 #define USBD_CDC_ACM_MAX_PACKET    (0)
 #define USBD_CDC_ACM_MAX_PACKET1   (0)
 #endif
+#if    (USBD_BULK_ENABLE)
+#if    (USBD_BULK_HS_ENABLE)
+#define USBD_BULK_MAX_PACKET      ((USBD_BULK_HS_WMAXPACKETSIZE > USBD_BULK_WMAXPACKETSIZE) ? USBD_BULK_HS_WMAXPACKETSIZE : USBD_BULK_WMAXPACKETSIZE)
+#else
+#define USBD_BULK_MAX_PACKET       (USBD_BULK_WMAXPACKETSIZE)
+#endif
+#else
+#define USBD_BULK_MAX_PACKET       (0)
+#endif
 #define USBD_MAX_PACKET_CALC0     ((USBD_HID_MAX_PACKET   > USBD_HID_MAX_PACKET      ) ? (USBD_HID_MAX_PACKET  ) : (USBD_HID_MAX_PACKET      ))
 #define USBD_MAX_PACKET_CALC1     ((USBD_ADC_MAX_PACKET   > USBD_CDC_ACM_MAX_PACKET  ) ? (USBD_ADC_MAX_PACKET  ) : (USBD_CDC_ACM_MAX_PACKET  ))
 #define USBD_MAX_PACKET_CALC2     ((USBD_MAX_PACKET_CALC0 > USBD_MAX_PACKET_CALC1    ) ? (USBD_MAX_PACKET_CALC0) : (USBD_MAX_PACKET_CALC1    ))
-#define USBD_MAX_PACKET           ((USBD_MAX_PACKET_CALC2 > USBD_CDC_ACM_MAX_PACKET1 ) ? (USBD_MAX_PACKET_CALC2) : (USBD_CDC_ACM_MAX_PACKET1 ))
+#define USBD_MAX_PACKET_CALC3     ((USBD_MAX_PACKET_CALC2 > USBD_CDC_ACM_MAX_PACKET1 ) ? (USBD_MAX_PACKET_CALC2) : (USBD_CDC_ACM_MAX_PACKET1 ))
+#define USBD_MAX_PACKET           ((USBD_MAX_PACKET_CALC3 > USBD_BULK_MAX_PACKET     ) ? (USBD_MAX_PACKET_CALC3) : (USBD_BULK_MAX_PACKET     ))
 
 
 /*------------------------------------------------------------------------------
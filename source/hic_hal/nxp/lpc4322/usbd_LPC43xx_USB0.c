@@ -75,13 +75,32 @@ uint32_t cmpl_pnd;
 uint8_t __align(4096) EPBufPool[EP_BUF_POOL_SIZE]
 #else
 /* supported classes are used */
-uint8_t __align(4096) EPBufPool[
-    USBD_MAX_PACKET0                                                                                                     * 2 +
-    USBD_HID_ENABLE     *  (HS(USBD_HID_HS_ENABLE)      ? USBD_HID_HS_WMAXPACKETSIZE     : USBD_HID_WMAXPACKETSIZE)      * 2 +
-    USBD_MSC_ENABLE     *  (HS(USBD_MSC_HS_ENABLE)      ? USBD_MSC_HS_WMAXPACKETSIZE     : USBD_MSC_WMAXPACKETSIZE)      * 2 +
-    USBD_ADC_ENABLE     *  (HS(USBD_ADC_HS_ENABLE)      ? USBD_ADC_HS_WMAXPACKETSIZE     : USBD_ADC_WMAXPACKETSIZE)          +
-    USBD_CDC_ACM_ENABLE * ((HS(USBD_CDC_ACM_HS_ENABLE) ? USBD_CDC_ACM_HS_WMAXPACKETSIZE  : USBD_CDC_ACM_WMAXPACKETSIZE)      +
-                           (HS(USBD_CDC_ACM_HS_ENABLE) ? USBD_CDC_ACM_HS_WMAXPACKETSIZE1 : USBD_CDC_ACM_WMAXPACKETSIZE1) * 2)];
+#define EP_BUF_POOL_SIZE (                                                                                                   \
+    USBD_MAX_PACKET0                                                                                                     * 2 + \
+    USBD_HID_ENABLE     *  (HS(USBD_HID_HS_ENABLE)      ? USBD_HID_HS_WMAXPACKETSIZE     : USBD_HID_WMAXPACKETSIZE)      * 2 + \
+    USBD_MSC_ENABLE     *  (HS(USBD_MSC_HS_ENABLE)      ? USBD_MSC_HS_WMAXPACKETSIZE     : USBD_MSC_WMAXPACKETSIZE)      * 2 + \
+    USBD_ADC_ENABLE     *  (HS(USBD_ADC_HS_ENABLE)      ? USBD_ADC_HS_WMAXPACKETSIZE     : USBD_ADC_WMAXPACKETSIZE)          + \
+    USBD_CDC_ACM_ENABLE * ((HS(USBD_CDC_ACM_HS_ENABLE)  ? USBD_CDC_ACM_HS_WMAXPACKETSIZE  : USBD_CDC_ACM_WMAXPACKETSIZE)     + \
+                           (HS(USBD_CDC_ACM_HS_ENABLE1) ? USBD_CDC_ACM_HS_WMAXPACKETSIZE1 : USBD_CDC_ACM_WMAXPACKETSIZE1) * 2) + \
+    USBD_BULK_ENABLE    *  (HS(USBD_BULK_HS_ENABLE)     ? USBD_BULK_HS_WMAXPACKETSIZE    : USBD_BULK_WMAXPACKETSIZE)      * (2 * (USBD_BULK_EP_CMDOUT != 0) + (USBD_BULK_EP_SWOIN != 0)))
+
+/* USBD_ConfigEP() hands out wMaxPacketSize bytes of the pool to every endpoint,
+   and the High-speed descriptors always report the High-speed packet sizes */
+#define EP_SIZE(fs, hs) ((USBD_HS_ENABLE && ((hs) > (fs))) ? (hs) : (fs))
+#define EP_BUF_POOL_NEEDED (                                                                                 \
+    USBD_MAX_PACKET0                                                                                * 2 + \
+    USBD_HID_ENABLE     * EP_SIZE(USBD_HID_WMAXPACKETSIZE,      USBD_HID_HS_WMAXPACKETSIZE)      * 2 + \
+    USBD_MSC_ENABLE     * EP_SIZE(USBD_MSC_WMAXPACKETSIZE,      USBD_MSC_HS_WMAXPACKETSIZE)      * 2 + \
+    USBD_ADC_ENABLE     * EP_SIZE(USBD_ADC_WMAXPACKETSIZE,      USBD_ADC_HS_WMAXPACKETSIZE)          + \
+    USBD_CDC_ACM_ENABLE * (EP_SIZE(USBD_CDC_ACM_WMAXPACKETSIZE, USBD_CDC_ACM_HS_WMAXPACKETSIZE)      + \
+                           EP_SIZE(USBD_CDC_ACM_WMAXPACKETSIZE1, USBD_CDC_ACM_HS_WMAXPACKETSIZE1) * 2) + \
+    USBD_BULK_ENABLE    * EP_SIZE(USBD_BULK_WMAXPACKETSIZE,     USBD_BULK_HS_WMAXPACKETSIZE)     * (2 * (USBD_BULK_EP_CMDOUT != 0) + (USBD_BULK_EP_SWOIN != 0)))
+
+#if (EP_BUF_POOL_SIZE < EP_BUF_POOL_NEEDED)
+#error "EPBufPool does not cover every endpoint, enable High-speed for the class with the larger High-speed packet"
+#endif
+
+uint8_t __align(4096) EPBufPool[EP_BUF_POOL_SIZE];
 #endif
 
 void USBD_PrimeEp(uint32_t EPNum, uint32_t cnt);
@@ -367,6 +386,7 @@ void USBD_ConfigEP(USB_ENDPOINT_DESCRIPTOR *pEPD)
     }
 
     dTDx[idx].buf[0]    = (uint32_t)(Ep[idx].buf);
+    dTDx[idx].buf[1]    = ((uint32_t)(Ep[idx].buf) & ~0xFFF) + 0x1000;
     dTDx[idx].next_dTD  =  1;
     EPQHx[idx].cap      = (Ep[idx].maxPacket << 16) |
                           (1UL               << 29);
@@ -541,7 +561,10 @@ void USBD_PrimeEp(uint32_t EPNum, uint32_t cnt)
         idx    = EP_OUT_IDX(EPNum);
     }
 
+    /* High-speed packets may cross a 4K page of EPBufPool, so also provide
+       the following page to the controller */
     dTDx[idx].buf[0]    = (uint32_t)(Ep[idx].buf);
+    dTDx[idx].buf[1]    = ((uint32_t)(Ep[idx].buf) & ~0xFFF) + 0x1000;
     dTDx[idx].next_dTD  = 1;
 
     if (IsoEp & val) {
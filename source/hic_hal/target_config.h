@@ -55,6 +55,7 @@ typedef struct target_cfg {
     uint8_t erase_reset;            /*!< Reset after performing an erase */
     const sector_info_t* sectors_info; 
     int sector_info_length;
+    uint32_t swd_targetsel;         /*!< TARGETSEL of the target DP on an SWD multi-drop bus, 0 for a single target */
 } target_cfg_t;
 
 extern target_cfg_t target_device;
@@ -0,0 +1,60 @@
+/**
+ * @file    uart_swo.h
+ * @brief   UART receiver used to capture SWO trace from the target
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UART_SWO_H
+#define UART_SWO_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Events passed to the capture callback (from interrupt context) */
+#define UART_SWO_EVENT_RECEIVE_COMPLETE     (1UL << 0)  // Requested number of bytes received
+#define UART_SWO_EVENT_RX_OVERFLOW          (1UL << 1)  // Byte lost because no buffer was armed
+#define UART_SWO_EVENT_RX_ERROR             (1UL << 2)  // Break, framing or parity error
+
+typedef void (*uart_swo_callback_t)(uint32_t event);
+
+/*-----------------------------------------------------------------------------
+ * FUNCTION PROTOTYPES
+ *----------------------------------------------------------------------------*/
+
+/* SWO capture UART driver function prototypes. The SWO pin of the target is
+ * wired to the RX line of a UART that is not used by the virtual COM port.
+ * Received bytes are written directly into the buffer armed with
+ * uart_swo_receive() so the trace ring in SWO.c is filled without copying. */
+extern int32_t  uart_swo_initialize(uart_swo_callback_t cb);
+extern int32_t  uart_swo_uninitialize(void);
+extern uint32_t uart_swo_set_baudrate(uint32_t baudrate);
+extern int32_t  uart_swo_enable(bool enable);
+extern int32_t  uart_swo_receive(uint8_t *data, uint32_t num);
+extern uint32_t uart_swo_abort_receive(void);
+extern uint32_t uart_swo_get_rx_count(void);
+extern bool     uart_swo_rx_busy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,393 @@
+/**
+ * @file    usbd_bulk.c
+ * @brief   Vendor specific bulk interface driver
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RTL.h"
+#include "rl_usb.h"
+#include "usb_for_lib.h"
+
+
+/* Bulk In transfer state. The data is sent straight from the caller's buffer
+   so it must stay untouched until the completion callback is called.        */
+typedef struct {
+    const U8 *ptrData;
+    U32 DataLen;
+    U32 SentLen;
+    BOOL SendZLP;
+    volatile BOOL SendActive;
+} BULK_IN_STATE;
+
+static BULK_IN_STATE CmdIn;             /* CMSIS-DAP response                */
+static BULK_IN_STATE SWOIn;             /* SWO trace stream                  */
+static U32 CmdReceLen;                  /* Command bytes in USBD_BULK_CmdBuf */
+static BOOL CmdOutHeld;                 /* Command packet left in endpoint   */
+
+
+/* Dummy Weak Functions that need to be provided by user */
+__weak void usbd_bulk_init(void)
+{
+
+}
+__weak BOOL usbd_bulk_cmd_ready(void)
+{
+    return (__TRUE);
+}
+__weak void usbd_bulk_cmd_received(U8 *buf, int len)
+{
+
+}
+__weak void usbd_bulk_cmd_complete(void)
+{
+
+}
+__weak void usbd_bulk_swo_complete(void)
+{
+
+}
+
+
+/*
+ *  USB Device Vendor Bulk In Transfer Start
+ *    Parameters:      in:     transfer state
+ *                     buf:    pointer to data (must stay valid until sent)
+ *                     len:    number of bytes to send
+ *    Return Value:    TRUE - transfer started, FALSE - busy or not configured
+ */
+
+static BOOL USBD_BULK_InStart(BULK_IN_STATE *in, const U8 *buf, int32_t len)
+{
+    if ((len <= 0) || !USBD_Configuration || in->SendActive) {
+        return (__FALSE);
+    }
+
+    in->ptrData    = buf;
+    in->DataLen    = len;
+    in->SentLen    = 0;
+    in->SendZLP    = __FALSE;
+    in->SendActive = __TRUE;
+    return (__TRUE);
+}
+
+
+/*
+ *  USB Device Vendor Bulk In Transfer Abort
+ *    Parameters:      in:     transfer state
+ *    Return Value:    TRUE - a transfer was active, FALSE - it was idle
+ */
+
+static BOOL USBD_BULK_InAbort(BULK_IN_STATE *in)
+{
+    BOOL active = in->SendActive;
+
+    in->SendActive = __FALSE;
+    in->ptrData    = 0;
+    in->DataLen    = 0;
+    in->SentLen    = 0;
+    in->SendZLP    = __FALSE;
+    return (active);
+}
+
+
+/*
+ *  USB Device Vendor Bulk In Transfer Next Packet
+ *   Sends the next packet of the active transfer, terminated with a ZLP if
+ *   the transfer ends on a packet boundary
+ *    Parameters:      in:     transfer state
+ *                     ep:     In endpoint number
+ *    Return Value:    TRUE - transfer just completed, FALSE - otherwise
+ */
+
+static BOOL USBD_BULK_InNext(BULK_IN_STATE *in, U8 ep)
+{
+    U32 max_packet;
+    U32 len;
+
+    if (!in->SendActive) {
+        return (__FALSE);
+    }
+
+    max_packet = usbd_bulk_maxpacketsize[USBD_HighSpeed];
+    len = in->DataLen - in->SentLen;
+
+    if ((len == 0) && !in->SendZLP) {
+        in->SendActive = __FALSE;
+        return (__TRUE);
+    }
+
+    if (len > max_packet) {
+        len = max_packet;
+    }
+
+    USBD_WriteEP(ep | 0x80, (U8 *)(in->ptrData + in->SentLen), len);
+    in->SentLen += len;
+    in->SendZLP = (in->SentLen == in->DataLen) && (len == max_packet);
+    return (__FALSE);
+}
+
+
+/*
+ *  USB Device Vendor Bulk Command Response Send
+ *   Start sending a CMSIS-DAP response on the Response Bulk In endpoint
+ *    Parameters:      buf:    pointer to data (must stay valid until sent)
+ *                     len:    number of bytes to send
+ *    Return Value:    number of bytes queued, 0 if busy or not configured
+ */
+
+int32_t USBD_BULK_CMD_DataSend(const uint8_t *buf, int32_t len)
+{
+    if (!USBD_BULK_InStart(&CmdIn, buf, len)) {
+        return (0);
+    }
+
+    USBD_BULK_EP_CMDIN_Event(0);
+    return (len);
+}
+
+
+/*
+ *  USB Device Vendor Bulk Command Receive Resume
+ *   Read the command packet held back while the user had no room for it.
+ *   Must not be interrupted by the command out endpoint event.
+ *    Parameters:      None
+ *    Return Value:    None
+ */
+
+void USBD_BULK_CMD_Resume(void)
+{
+    if (CmdOutHeld) {
+        CmdOutHeld = __FALSE;
+        USBD_BULK_EP_CMDOUT_Event(0);
+    }
+}
+
+
+/*
+ *  USB Device Vendor Bulk SWO Data Send
+ *   Start sending a block of trace data on the SWO Bulk In endpoint
+ *    Parameters:      buf:    pointer to data (must stay valid until sent)
+ *                     len:    number of bytes to send
+ *    Return Value:    number of bytes queued, 0 if busy or not configured
+ */
+
+int32_t USBD_BULK_SWO_DataSend(const uint8_t *buf, int32_t len)
+{
+    if ((usbd_bulk_ep_swoin == 0) || !USBD_BULK_InStart(&SWOIn, buf, len)) {
+        return (0);
+    }
+
+    USBD_BULK_EP_SWOIN_Event(0);
+    return (len);
+}
+
+
+/*
+ *  USB Device Vendor Bulk SWO Abort
+ *   Drop the trace block being sent. The completion callback is not called.
+ *    Parameters:      None
+ *    Return Value:    None
+ */
+
+void USBD_BULK_SWO_Abort(void)
+{
+    USBD_BULK_InAbort(&SWOIn);
+}
+
+
+/*
+ *  USB Device Vendor Bulk Reset Event
+ *   Called automatically on USB Device Reset
+ *    Parameters:      None
+ *    Return Value:    None
+ */
+
+void USBD_BULK_Reset_Event(void)
+{
+    CmdReceLen = 0;
+    CmdOutHeld = __FALSE;
+
+    /* Release the buffers of interrupted transfers so the owners can send
+       again once the host configures the device again */
+    if (USBD_BULK_InAbort(&CmdIn)) {
+        usbd_bulk_cmd_complete();
+    }
+
+    if (USBD_BULK_InAbort(&SWOIn)) {
+        usbd_bulk_swo_complete();
+    }
+}
+
+
+/*
+ *  USB Device Vendor Bulk Command Out Endpoint Event
+ *   Collects a command, which ends with a short packet or when the command
+ *   buffer is full. While the user has no room for a command the packet is
+ *   left in the endpoint, which is then not armed again and NAKs the host
+ *   until USBD_BULK_CMD_Resume is called.
+ *    Parameters:      event
+ *    Return Value:    None
+ */
+
+void USBD_BULK_EP_CMDOUT_Event(U32 event)
+{
+    U32 len;
+    U32 max_packet;
+
+    if (!usbd_bulk_cmd_ready()) {
+        CmdOutHeld = __TRUE;
+        return;
+    }
+
+    max_packet = usbd_bulk_maxpacketsize[USBD_HighSpeed];
+
+    if ((usbd_bulk_cmd_max_sz - CmdReceLen) < max_packet) {
+        /* Command does not fit, discard what was collected so far */
+        CmdReceLen = 0;
+    }
+
+    len = USBD_ReadEP(usbd_bulk_ep_cmdout, USBD_BULK_CmdBuf + CmdReceLen, usbd_bulk_cmd_max_sz - CmdReceLen);
+    CmdReceLen += len;
+
+    if ((len < max_packet) || (CmdReceLen == usbd_bulk_cmd_max_sz)) {
+        if (CmdReceLen) {
+            usbd_bulk_cmd_received(USBD_BULK_CmdBuf, CmdReceLen);
+        }
+
+        CmdReceLen = 0;
+    }
+}
+
+
+/*
+ *  USB Device Vendor Bulk Response In Endpoint Event
+ *    Parameters:      event
+ *    Return Value:    None
+ */
+
+void USBD_BULK_EP_CMDIN_Event(U32 event)
+{
+    if (USBD_BULK_InNext(&CmdIn, usbd_bulk_ep_cmdin)) {
+        usbd_bulk_cmd_complete();
+    }
+}
+
+
+/*
+ *  USB Device Vendor Bulk Command In/Out Endpoint Event
+ *    Parameters:      event
+ *    Return Value:    None
+ */
+
+void USBD_BULK_EP_CMD_Event(U32 event)
+{
+    if (event & USBD_EVT_OUT) {
+        USBD_BULK_EP_CMDOUT_Event(0);
+    }
+
+    if (event & USBD_EVT_IN) {
+        USBD_BULK_EP_CMDIN_Event(0);
+    }
+}
+
+
+/*
+ *  USB Device Vendor Bulk SWO In Endpoint Event
+ *    Parameters:      event
+ *    Return Value:    None
+ */
+
+void USBD_BULK_EP_SWOIN_Event(U32 event)
+{
+    if (USBD_BULK_InNext(&SWOIn, usbd_bulk_ep_swoin)) {
+        usbd_bulk_swo_complete();
+    }
+}
+
+
+#ifdef __RTX
+
+/*
+ *  USB Device Vendor Bulk Response In Endpoint Event Task
+ *    Parameters:      None
+ *    Return Value:    None
+ */
+
+__task void USBD_RTX_BULK_EP_CMDIN_Event(void)
+{
+    for (;;) {
+        usbd_os_evt_wait_or(0xFFFF, 0xFFFF);
+
+        if (usbd_os_evt_get() & USBD_EVT_IN) {
+            USBD_BULK_EP_CMDIN_Event(0);
+        }
+    }
+}
+
+
+/*
+ *  USB Device Vendor Bulk Command Out Endpoint Event Task
+ *    Parameters:      None
+ *    Return Value:    None
+ */
+
+__task void USBD_RTX_BULK_EP_CMDOUT_Event(void)
+{
+    for (;;) {
+        usbd_os_evt_wait_or(0xFFFF, 0xFFFF);
+
+        if (usbd_os_evt_get() & USBD_EVT_OUT) {
+            USBD_BULK_EP_CMDOUT_Event(0);
+        }
+    }
+}
+
+
+/*
+ *  USB Device Vendor Bulk Command In/Out Endpoint Event Task
+ *    Parameters:      None
+ *    Return Value:    None
+ */
+
+__task void USBD_RTX_BULK_EP_CMD_Event(void)
+{
+    for (;;) {
+        usbd_os_evt_wait_or(0xFFFF, 0xFFFF);
+        USBD_BULK_EP_CMD_Event(usbd_os_evt_get());
+    }
+}
+
+
+/*
+ *  USB Device Vendor Bulk SWO In Endpoint Event Task
+ *    Parameters:      None
+ *    Return Value:    None
+ */
+
+__task void USBD_RTX_BULK_EP_SWOIN_Event(void)
+{
+    for (;;) {
+        usbd_os_evt_wait_or(0xFFFF, 0xFFFF);
+
+        if (usbd_os_evt_get() & USBD_EVT_IN) {
+            USBD_BULK_EP_SWOIN_Event(0);
+        }
+    }
+}
+
+#endif
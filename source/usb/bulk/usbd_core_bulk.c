@@ -0,0 +1,59 @@
+/**
+ * @file    usbd_core_bulk.c
+ * @brief   Vendor specific bulk interface core requests
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "RTL.h"
+#include "rl_usb.h"
+#include "usb_for_lib.h"
+
+
+/*
+ *  USB Device Endpoint 0 Event Callback - Vendor specific handling (Setup Request To Device)
+ *   Answers the Microsoft OS 2.0 descriptor set request announced in the
+ *   platform capability of the BOS descriptor
+ *    Parameters:      none
+ *    Return Value:    TRUE - Setup vendor request ok, FALSE - Setup vendor request not supported
+ */
+
+__weak BOOL USBD_EndPoint0_Setup_BULK_ReqToDevice(void)
+{
+    U32 len;
+
+    if ((USBD_SetupPacket.bRequest != usbd_bulk_ms_vendor_code) ||
+            (USBD_SetupPacket.wIndex != MS_OS_20_DESCRIPTOR_INDEX) ||
+            (USBD_SetupPacket.bmRequestType.Dir != REQUEST_DEVICE_TO_HOST)) {
+        return (__FALSE);
+    }
+
+    len = USBD_MSOS20DescriptorSetSize;
+    USBD_EP0Data.pData = (U8 *)USBD_MSOS20DescriptorSet;
+
+    if (USBD_EP0Data.Count > len) {
+        USBD_EP0Data.Count = len;
+
+        if (!(USBD_EP0Data.Count & (usbd_max_packet0 - 1))) {
+            USBD_ZLP = 1;
+        }
+    }
+
+    USBD_DataInStage();                                        /* send requested data */
+    return (__TRUE);
+}
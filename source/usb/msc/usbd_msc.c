@@ -28,6 +28,7 @@
 #include "macro.h"
 
 BOOL USBD_MSC_MediaReady = __FALSE;
+BOOL USBD_MSC_MediaChanged = __FALSE;
 BOOL USBD_MSC_ReadOnly = __FALSE;
 U32 USBD_MSC_MemorySize;
 U32 USBD_MSC_BlockSize;
@@ -48,6 +49,14 @@ U32 Length;     /* R/W Length */
 U8 BulkStage;   /* Bulk Stage */
 U32 BulkLen;    /* Bulk In/Out Length */
 
+#if (MSC_RAW_LUN != 0)
+#define MSC_MAX_LUN     MSC_LUN_RAW
+#define LUN_IS_RAW()    (USBD_MSC_CBW.bLUN == MSC_LUN_RAW)
+#else
+#define MSC_MAX_LUN     0
+#define LUN_IS_RAW()    0
+#endif
+
 
 /* Dummy Weak Functions that need to be provided by user */
 __weak void usbd_msc_init()
@@ -61,6 +70,10 @@ __weak void usbd_msc_read_sect(U32 block, U8 *buf, U32 num_of_blocks)
 __weak void usbd_msc_write_sect(U32 block, U8 *buf, U32 num_of_blocks)
 {
 
+}
+__weak void usbd_msc_raw_write_sect(U32 block, U8 *buf, U32 num_of_blocks)
+{
+
 }
 __weak void usbd_msc_start_stop(BOOL start)
 {
@@ -68,6 +81,29 @@ __weak void usbd_msc_start_stop(BOOL start)
 }
 
 
+/* Sector access for the logical unit addressed by the current command */
+static void msc_read_sect(U32 block, U8 *buf, U32 num_of_blocks)
+{
+    if (LUN_IS_RAW()) {
+        /* The raw logical unit is write only and reads back as zeros */
+        memset(buf, 0, num_of_blocks * USBD_MSC_BlockSize);
+        return;
+    }
+
+    usbd_msc_read_sect(block, buf, num_of_blocks);
+}
+
+static void msc_write_sect(U32 block, U8 *buf, U32 num_of_blocks)
+{
+    if (LUN_IS_RAW()) {
+        usbd_msc_raw_write_sect(block, buf, num_of_blocks);
+        return;
+    }
+
+    usbd_msc_write_sect(block, buf, num_of_blocks);
+}
+
+
 /*
  *  Set Stall for USB Device MSC Endpoint
  *    Parameters:      EPNum: USB Device Endpoint Number
@@ -131,7 +167,7 @@ BOOL USBD_MSC_Reset(void)
 
 BOOL USBD_MSC_GetMaxLUN(void)
 {
-    USBD_EP0Buf[0] = 0;                      /* one LUN associated with this device */
+    USBD_EP0Buf[0] = MSC_MAX_LUN;            /* highest LUN associated with this device */
     return (__TRUE);
 }
 
@@ -144,9 +180,18 @@ BOOL USBD_MSC_GetMaxLUN(void)
 
 BOOL USBD_MSC_CheckMedia(void)
 {
-    USBD_MSC_MediaReadyEx = USBD_MSC_MediaReady;
+    BOOL ready;
 
-    if (!USBD_MSC_MediaReady) {
+    if (LUN_IS_RAW()) {
+        /* The raw unit is ready along with the drive and never reports a media change */
+        ready = USBD_MSC_MediaReady;
+    } else {
+        USBD_MSC_MediaReadyEx = USBD_MSC_MediaReady;
+        /* A pending media change fails the command until the host reads the sense data */
+        ready = USBD_MSC_MediaReady && !USBD_MSC_MediaChanged;
+    }
+
+    if (!ready) {
         if (USBD_MSC_CBW.dDataLength) {
             if ((USBD_MSC_CBW.bmFlags & 0x80) != 0) {
                 USBD_MSC_SetStallEP(usbd_msc_ep_bulkin | 0x80);
@@ -202,7 +247,7 @@ void USBD_MSC_MemoryRead(void)
             m = USBD_MSC_BlockGroup;
         }
 
-        usbd_msc_read_sect(Block, USBD_MSC_BlockBuf, m);
+        msc_read_sect(Block, USBD_MSC_BlockBuf, m);
     }
 
     if (n) {
@@ -272,11 +317,11 @@ void USBD_MSC_MemoryWrite(void)
                 n = USBD_MSC_BlockGroup;
             }
 
-            usbd_msc_write_sect(Block, USBD_MSC_BlockBuf, n);
+            msc_write_sect(Block, USBD_MSC_BlockBuf, n);
             Offset = 0;
             Block += n;
         } else if (Offset == USBD_MSC_BlockGroup * USBD_MSC_BlockSize) {
-            usbd_msc_write_sect(Block, USBD_MSC_BlockBuf, USBD_MSC_BlockGroup);
+            msc_write_sect(Block, USBD_MSC_BlockBuf, USBD_MSC_BlockGroup);
             Offset = 0;
             Block += USBD_MSC_BlockGroup;
         }
@@ -325,7 +370,7 @@ void USBD_MSC_MemoryVerify(void)
                 n = USBD_MSC_BlockGroup;
             }
 
-            usbd_msc_read_sect(Block, USBD_MSC_BlockBuf, n);
+            msc_read_sect(Block, USBD_MSC_BlockBuf, n);
         }
 
         for (n = 0; n < BulkLen; n++) {
@@ -514,7 +559,12 @@ void USBD_MSC_RequestSense(void)
     USBD_MSC_BulkBuf[ 0] = 0x70;             /* Response Code */
     USBD_MSC_BulkBuf[ 1] = 0x00;
 
-    if ((USBD_MSC_MediaReadyEx ^ USBD_MSC_MediaReady) & USBD_MSC_MediaReady) {  /* If media state changed to ready */
+    if (!LUN_IS_RAW() && USBD_MSC_MediaReady && USBD_MSC_MediaChanged) {  /* If media content changed in place */
+        USBD_MSC_BulkBuf[ 2] = 0x06;           /* UNIT ATTENTION */
+        USBD_MSC_BulkBuf[12] = 0x28;           /* Additional Sense Code: Not ready to ready transition, medium may have changed */
+        USBD_MSC_BulkBuf[13] = 0x00;           /* Additional Sense Code Qualifier */
+        USBD_MSC_MediaChanged = __FALSE;
+    } else if (!LUN_IS_RAW() && ((USBD_MSC_MediaReadyEx ^ USBD_MSC_MediaReady) & USBD_MSC_MediaReady)) {  /* If media state changed to ready */
         USBD_MSC_BulkBuf[ 2] = 0x06;           /* UNIT ATTENTION */
         USBD_MSC_BulkBuf[12] = 0x28;           /* Additional Sense Code: Not ready to ready transition */
         USBD_MSC_BulkBuf[13] = 0x00;           /* Additional Sense Code Qualifier */
@@ -600,8 +650,11 @@ void USBD_MSC_Inquiry(void)
 void USBD_MSC_StartStopUnit(void)
 {
     if (!USBD_MSC_CBW.CB[3]) {               /* If power condition modifier is 0 */
-        USBD_MSC_MediaReady  = USBD_MSC_CBW.CB[4] & 0x01;   /* Media ready = START bit value */
-        usbd_msc_start_stop(USBD_MSC_MediaReady);
+        if (!LUN_IS_RAW()) {                   /* Ejecting the raw unit leaves the drive mounted */
+            USBD_MSC_MediaReady  = USBD_MSC_CBW.CB[4] & 0x01;   /* Media ready = START bit value */
+            usbd_msc_start_stop(USBD_MSC_MediaReady);
+        }
+
         USBD_MSC_CSW.bStatus = CSW_CMD_PASSED; /* Start Stop Unit -> pass */
         USBD_MSC_SetCSW();
         return;
@@ -648,7 +701,7 @@ void USBD_MSC_ModeSense6(void)
 
     USBD_MSC_BulkBuf[ 0] = 0x03;
     USBD_MSC_BulkBuf[ 1] = 0x00;
-    USBD_MSC_BulkBuf[ 2] = (USBD_MSC_ReadOnly << 7);
+    USBD_MSC_BulkBuf[ 2] = ((USBD_MSC_ReadOnly && !LUN_IS_RAW()) << 7);
     USBD_MSC_BulkBuf[ 3] = 0x00;
     BulkLen = 4;
 
@@ -682,7 +735,7 @@ void USBD_MSC_ModeSense10(void)
     USBD_MSC_BulkBuf[ 0] = 0x00;
     USBD_MSC_BulkBuf[ 1] = 0x06;
     USBD_MSC_BulkBuf[ 2] = 0x00;
-    USBD_MSC_BulkBuf[ 3] = (USBD_MSC_ReadOnly << 7);
+    USBD_MSC_BulkBuf[ 3] = ((USBD_MSC_ReadOnly && !LUN_IS_RAW()) << 7);
     USBD_MSC_BulkBuf[ 4] = 0x00;
     USBD_MSC_BulkBuf[ 5] = 0x00;
     USBD_MSC_BulkBuf[ 6] = 0x00;
@@ -863,7 +916,7 @@ void USBD_MSC_GetCBW(void)
         USBD_MSC_CSW.dTag = USBD_MSC_CBW.dTag;
         USBD_MSC_CSW.dDataResidue = USBD_MSC_CBW.dDataLength;
 
-        if ((USBD_MSC_CBW.bLUN      >  0) ||
+        if ((USBD_MSC_CBW.bLUN      >  MSC_MAX_LUN) ||
                 (USBD_MSC_CBW.bCBLength <  1) ||
                 (USBD_MSC_CBW.bCBLength > 16)) {
 fail:
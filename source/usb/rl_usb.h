@@ -50,6 +50,7 @@ extern void  usbd_msc_init(void);
 extern void  usbd_msc_read_sect(U32 block, U8 *buf, U32 num_of_blocks);
 extern void  usbd_msc_write_sect(U32 block, U8 *buf, U32 num_of_blocks);
 extern void  usbd_msc_start_stop(BOOL start);
+extern void  usbd_msc_raw_write_sect(U32 block, U8 *buf, U32 num_of_blocks);
 
 /* USB Device user functions imported to USB Audio Class module               */
 extern void  usbd_adc_init(void);
@@ -83,6 +84,18 @@ extern int32_t  USBD_CDC_ACM_GetLineCoding(void);
 extern int32_t  USBD_CDC_ACM_SetControlLineState(uint16_t ctrl_bmp);
 extern int32_t  USBD_CDC_ACM_SendBreak(uint16_t dur);
 
+/* USB Device user functions imported to USB Vendor Bulk Class module         */
+extern void  usbd_bulk_init(void);
+extern BOOL  usbd_bulk_cmd_ready(void);
+extern void  usbd_bulk_cmd_received(U8 *buf, int len);
+extern void  usbd_bulk_cmd_complete(void);
+extern void  usbd_bulk_swo_complete(void);
+/* USB Device Vendor Bulk class user functions                                */
+extern int32_t  USBD_BULK_CMD_DataSend(const uint8_t *buf, int32_t len);
+extern void     USBD_BULK_CMD_Resume(void);
+extern int32_t  USBD_BULK_SWO_DataSend(const uint8_t *buf, int32_t len);
+extern void     USBD_BULK_SWO_Abort(void);
+
 /* USB Device user functions imported to USB Custom Class module              */
 extern void  usbd_cls_init(void);
 extern void  usbd_cls_sof(void);
@@ -33,9 +33,11 @@
 #include "usbd_core_cdc.h"
 #include "usbd_core_hid.h"
 #include "usbd_core_msc.h"
+#include "usbd_core_bulk.h"
 
 #include "usbd_desc.h"
 #include "usbd_event.h"
+#include "usbd_bulk.h"
 #include "usbd_cdc_acm.h"
 #include "usbd_hid.h"
 #include "usbd_msc.h"
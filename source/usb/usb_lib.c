@@ -128,6 +128,44 @@ U8 USBD_CDC_ACM_ReceiveBuf[USBD_CDC_ACM_RECEIVEBUF_SIZE];
 U8 USBD_CDC_ACM_NotifyBuf[10];
 #endif
 
+#ifndef USBD_BULK_ENABLE
+#define USBD_BULK_ENABLE     0
+#endif
+#ifndef USBD_BULK_EP_CMDOUT
+#define USBD_BULK_EP_CMDOUT  0
+#endif
+#ifndef USBD_BULK_EP_SWOIN
+#define USBD_BULK_EP_SWOIN   0
+#endif
+
+#if    (USBD_BULK_ENABLE)
+const U8 usbd_bulk_if_num = USBD_BULK_IF_NUM;
+const U8 usbd_bulk_ep_cmdout = USBD_BULK_EP_CMDOUT;
+const U8 usbd_bulk_ep_cmdin = USBD_BULK_EP_CMDIN;
+const U8 usbd_bulk_ep_swoin = USBD_BULK_EP_SWOIN;
+const U16 usbd_bulk_maxpacketsize[2] = {USBD_BULK_WMAXPACKETSIZE, USBD_BULK_HS_WMAXPACKETSIZE};
+const U16 usbd_bulk_cmd_max_sz = USBD_BULK_CMD_MAX_SZ;
+const U8 usbd_bulk_ms_vendor_code = USBD_BULK_MS_VENDOR_CODE;
+U8 USBD_BULK_CmdBuf[USBD_BULK_CMD_MAX_SZ];
+#endif
+
+/* High-speed descriptors always report the High-speed packet sizes, while the
+   class buffers are only sized for them when the class High-speed is enabled */
+#if    (USBD_HS_ENABLE)
+#if    ((USBD_HID_ENABLE) && (!USBD_HID_HS_ENABLE) && (USBD_HID_HS_WMAXPACKETSIZE > USBD_HID_WMAXPACKETSIZE))
+#error "HID High-speed must be enabled for a High-speed packet larger than the Full-speed one!"
+#endif
+#if    ((USBD_MSC_ENABLE) && (!USBD_MSC_HS_ENABLE) && (USBD_MSC_HS_WMAXPACKETSIZE > USBD_MSC_WMAXPACKETSIZE))
+#error "MSC High-speed must be enabled for a High-speed packet larger than the Full-speed one!"
+#endif
+#if    ((USBD_CDC_ACM_ENABLE) && (!USBD_CDC_ACM_HS_ENABLE1) && (USBD_CDC_ACM_HS_WMAXPACKETSIZE1 > USBD_CDC_ACM_WMAXPACKETSIZE1))
+#error "CDC High-speed must be enabled for a High-speed packet larger than the Full-speed one!"
+#endif
+#if    ((USBD_BULK_ENABLE) && (!USBD_BULK_HS_ENABLE) && (USBD_BULK_HS_WMAXPACKETSIZE > USBD_BULK_WMAXPACKETSIZE))
+#error "Bulk High-speed must be enabled for a High-speed packet larger than the Full-speed one!"
+#endif
+#endif
+
 /*------------------------------------------------------------------------------
  *      USB Device Override Event Handler Fuctions
  *----------------------------------------------------------------------------*/
@@ -922,6 +960,275 @@ BOOL USBD_EndPoint0_Out_CDC_ReqToIF(void)
 }
 #endif  /* (USBD_CDC_ACM_ENABLE) */
 
+#if    (USBD_BULK_ENABLE)
+#ifdef __RTX
+#if    (USBD_BULK_EP_CMDIN != USBD_BULK_EP_CMDOUT)
+#if    (USBD_BULK_EP_CMDIN == 1)
+#define USBD_RTX_EndPoint1               USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 2)
+#define USBD_RTX_EndPoint2               USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 3)
+#define USBD_RTX_EndPoint3               USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 4)
+#define USBD_RTX_EndPoint4               USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 5)
+#define USBD_RTX_EndPoint5               USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 6)
+#define USBD_RTX_EndPoint6               USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 7)
+#define USBD_RTX_EndPoint7               USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 8)
+#define USBD_RTX_EndPoint8               USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 9)
+#define USBD_RTX_EndPoint9               USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 10)
+#define USBD_RTX_EndPoint10              USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 11)
+#define USBD_RTX_EndPoint11              USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 12)
+#define USBD_RTX_EndPoint12              USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 13)
+#define USBD_RTX_EndPoint13              USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 14)
+#define USBD_RTX_EndPoint14              USBD_RTX_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 15)
+#define USBD_RTX_EndPoint15              USBD_RTX_BULK_EP_CMDIN_Event
+#endif
+#if    (USBD_BULK_EP_CMDOUT == 1)
+#define USBD_RTX_EndPoint1               USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 2)
+#define USBD_RTX_EndPoint2               USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 3)
+#define USBD_RTX_EndPoint3               USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 4)
+#define USBD_RTX_EndPoint4               USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 5)
+#define USBD_RTX_EndPoint5               USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 6)
+#define USBD_RTX_EndPoint6               USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 7)
+#define USBD_RTX_EndPoint7               USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 8)
+#define USBD_RTX_EndPoint8               USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 9)
+#define USBD_RTX_EndPoint9               USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 10)
+#define USBD_RTX_EndPoint10              USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 11)
+#define USBD_RTX_EndPoint11              USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 12)
+#define USBD_RTX_EndPoint12              USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 13)
+#define USBD_RTX_EndPoint13              USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 14)
+#define USBD_RTX_EndPoint14              USBD_RTX_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 15)
+#define USBD_RTX_EndPoint15              USBD_RTX_BULK_EP_CMDOUT_Event
+#endif
+#else
+#if    (USBD_BULK_EP_CMDIN == 1)
+#define USBD_RTX_EndPoint1               USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 2)
+#define USBD_RTX_EndPoint2               USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 3)
+#define USBD_RTX_EndPoint3               USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 4)
+#define USBD_RTX_EndPoint4               USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 5)
+#define USBD_RTX_EndPoint5               USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 6)
+#define USBD_RTX_EndPoint6               USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 7)
+#define USBD_RTX_EndPoint7               USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 8)
+#define USBD_RTX_EndPoint8               USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 9)
+#define USBD_RTX_EndPoint9               USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 10)
+#define USBD_RTX_EndPoint10              USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 11)
+#define USBD_RTX_EndPoint11              USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 12)
+#define USBD_RTX_EndPoint12              USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 13)
+#define USBD_RTX_EndPoint13              USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 14)
+#define USBD_RTX_EndPoint14              USBD_RTX_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 15)
+#define USBD_RTX_EndPoint15              USBD_RTX_BULK_EP_CMD_Event
+#endif
+#endif
+#if    (USBD_BULK_EP_SWOIN != 0)
+#if    (USBD_BULK_EP_SWOIN == 1)
+#define USBD_RTX_EndPoint1               USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 2)
+#define USBD_RTX_EndPoint2               USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 3)
+#define USBD_RTX_EndPoint3               USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 4)
+#define USBD_RTX_EndPoint4               USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 5)
+#define USBD_RTX_EndPoint5               USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 6)
+#define USBD_RTX_EndPoint6               USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 7)
+#define USBD_RTX_EndPoint7               USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 8)
+#define USBD_RTX_EndPoint8               USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 9)
+#define USBD_RTX_EndPoint9               USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 10)
+#define USBD_RTX_EndPoint10              USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 11)
+#define USBD_RTX_EndPoint11              USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 12)
+#define USBD_RTX_EndPoint12              USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 13)
+#define USBD_RTX_EndPoint13              USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 14)
+#define USBD_RTX_EndPoint14              USBD_RTX_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 15)
+#define USBD_RTX_EndPoint15              USBD_RTX_BULK_EP_SWOIN_Event
+#endif
+#endif
+#else
+#if    (USBD_BULK_EP_CMDIN != USBD_BULK_EP_CMDOUT)
+#if    (USBD_BULK_EP_CMDIN == 1)
+#define USBD_EndPoint1                   USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 2)
+#define USBD_EndPoint2                   USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 3)
+#define USBD_EndPoint3                   USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 4)
+#define USBD_EndPoint4                   USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 5)
+#define USBD_EndPoint5                   USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 6)
+#define USBD_EndPoint6                   USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 7)
+#define USBD_EndPoint7                   USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 8)
+#define USBD_EndPoint8                   USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 9)
+#define USBD_EndPoint9                   USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 10)
+#define USBD_EndPoint10                  USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 11)
+#define USBD_EndPoint11                  USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 12)
+#define USBD_EndPoint12                  USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 13)
+#define USBD_EndPoint13                  USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 14)
+#define USBD_EndPoint14                  USBD_BULK_EP_CMDIN_Event
+#elif  (USBD_BULK_EP_CMDIN == 15)
+#define USBD_EndPoint15                  USBD_BULK_EP_CMDIN_Event
+#endif
+#if    (USBD_BULK_EP_CMDOUT == 1)
+#define USBD_EndPoint1                   USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 2)
+#define USBD_EndPoint2                   USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 3)
+#define USBD_EndPoint3                   USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 4)
+#define USBD_EndPoint4                   USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 5)
+#define USBD_EndPoint5                   USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 6)
+#define USBD_EndPoint6                   USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 7)
+#define USBD_EndPoint7                   USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 8)
+#define USBD_EndPoint8                   USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 9)
+#define USBD_EndPoint9                   USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 10)
+#define USBD_EndPoint10                  USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 11)
+#define USBD_EndPoint11                  USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 12)
+#define USBD_EndPoint12                  USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 13)
+#define USBD_EndPoint13                  USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 14)
+#define USBD_EndPoint14                  USBD_BULK_EP_CMDOUT_Event
+#elif  (USBD_BULK_EP_CMDOUT == 15)
+#define USBD_EndPoint15                  USBD_BULK_EP_CMDOUT_Event
+#endif
+#else
+#if    (USBD_BULK_EP_CMDIN == 1)
+#define USBD_EndPoint1                   USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 2)
+#define USBD_EndPoint2                   USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 3)
+#define USBD_EndPoint3                   USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 4)
+#define USBD_EndPoint4                   USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 5)
+#define USBD_EndPoint5                   USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 6)
+#define USBD_EndPoint6                   USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 7)
+#define USBD_EndPoint7                   USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 8)
+#define USBD_EndPoint8                   USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 9)
+#define USBD_EndPoint9                   USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 10)
+#define USBD_EndPoint10                  USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 11)
+#define USBD_EndPoint11                  USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 12)
+#define USBD_EndPoint12                  USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 13)
+#define USBD_EndPoint13                  USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 14)
+#define USBD_EndPoint14                  USBD_BULK_EP_CMD_Event
+#elif  (USBD_BULK_EP_CMDIN == 15)
+#define USBD_EndPoint15                  USBD_BULK_EP_CMD_Event
+#endif
+#endif
+#if    (USBD_BULK_EP_SWOIN != 0)
+#if    (USBD_BULK_EP_SWOIN == 1)
+#define USBD_EndPoint1                   USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 2)
+#define USBD_EndPoint2                   USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 3)
+#define USBD_EndPoint3                   USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 4)
+#define USBD_EndPoint4                   USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 5)
+#define USBD_EndPoint5                   USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 6)
+#define USBD_EndPoint6                   USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 7)
+#define USBD_EndPoint7                   USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 8)
+#define USBD_EndPoint8                   USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 9)
+#define USBD_EndPoint9                   USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 10)
+#define USBD_EndPoint10                  USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 11)
+#define USBD_EndPoint11                  USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 12)
+#define USBD_EndPoint12                  USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 13)
+#define USBD_EndPoint13                  USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 14)
+#define USBD_EndPoint14                  USBD_BULK_EP_SWOIN_Event
+#elif  (USBD_BULK_EP_SWOIN == 15)
+#define USBD_EndPoint15                  USBD_BULK_EP_SWOIN_Event
+#endif
+#endif
+#endif
+#else
+BOOL USBD_EndPoint0_Setup_BULK_ReqToDevice(void)
+{
+    return (__FALSE);
+}
+#endif  /* (USBD_BULK_ENABLE) */
+
 #if    (USBD_CLS_ENABLE)
 #else
 BOOL USBD_EndPoint0_Setup_CLS_ReqToDEV(void)
@@ -950,7 +1257,7 @@ BOOL USBD_EndPoint0_Out_CLS_ReqToEP(void)
 }
 #endif  /* (USBD_CLS_ENABLE) */
 
-#if   ((USBD_CDC_ACM_ENABLE))
+#if   ((USBD_CDC_ACM_ENABLE) || (USBD_BULK_ENABLE))
 #ifndef __RTX
 void USBD_Reset_Event(void)
 {
@@ -960,9 +1267,12 @@ void USBD_Reset_Event(void)
 #if    (USBD_MSC_ENABLE)
     USBD_MSC_Reset_Event();
 #endif    
+#if    (USBD_BULK_ENABLE)
+    USBD_BULK_Reset_Event();
+#endif
 }
 #endif
-#endif  /* ((USBD_CDC_ACM_ENABLE)) */
+#endif  /* ((USBD_CDC_ACM_ENABLE) || (USBD_BULK_ENABLE)) */
 
 #if   ((USBD_HID_ENABLE) || (USBD_ADC_ENABLE) || (USBD_CDC_ACM_ENABLE) || (USBD_CLS_ENABLE))
 #ifndef __RTX
@@ -1099,6 +1409,9 @@ __weak __task void USBD_RTX_Device(void)
 #if (USBD_MSC_ENABLE)
             USBD_MSC_Reset_Event();
 #endif    
+#if (USBD_BULK_ENABLE)
+            USBD_BULK_Reset_Event();
+#endif
         }
 
         if (evt & USBD_EVT_SOF) {
@@ -1259,6 +1572,9 @@ void usbd_class_init(void)
 #if (USBD_CDC_ACM_ENABLE)
     USBD_CDC_ACM_Initialize();
 #endif
+#if (USBD_BULK_ENABLE)
+    usbd_bulk_init();
+#endif
 #if (USBD_CLS_ENABLE)
     usbd_cls_init();
 #endif
@@ -1305,6 +1621,15 @@ typedef struct {
 #if !defined(USBD_CDC_ACM_EP_BULKOUT_STACK)
 #define USBD_CDC_ACM_EP_BULKOUT_STACK 0
 #endif
+#if !defined(USBD_BULK_EP_CMDIN_STACK)
+#define USBD_BULK_EP_CMDIN_STACK 0
+#endif
+#if !defined(USBD_BULK_EP_CMDOUT_STACK)
+#define USBD_BULK_EP_CMDOUT_STACK 0
+#endif
+#if !defined(USBD_BULK_EP_SWOIN_STACK)
+#define USBD_BULK_EP_SWOIN_STACK 0
+#endif
 
 #if USBD_HID_EP_INTIN == 0 && USBD_HID_EP_INTIN_STACK > 0
 #error "USBD_HID_EP_INTIN stack unused - must be 0"
@@ -1330,6 +1655,15 @@ typedef struct {
 #if USBD_CDC_ACM_EP_BULKOUT == 0 && USBD_CDC_ACM_EP_BULKOUT_STACK > 0
 #error "USBD_CDC_ACM_EP_BULKOUT stack unused - must be 0"
 #endif
+#if USBD_BULK_EP_CMDIN == 0 && USBD_BULK_EP_CMDIN_STACK > 0
+#error "USBD_BULK_EP_CMDIN stack unused - must be 0"
+#endif
+#if USBD_BULK_EP_CMDOUT == 0 && USBD_BULK_EP_CMDOUT_STACK > 0
+#error "USBD_BULK_EP_CMDOUT stack unused - must be 0"
+#endif
+#if USBD_BULK_EP_SWOIN == 0 && USBD_BULK_EP_SWOIN_STACK > 0
+#error "USBD_BULK_EP_SWOIN stack unused - must be 0"
+#endif
 
 #if USBD_ENABLE
 static U64 usbd_core_stack[USBD_RTX_CORE_STACK / 8];
@@ -1361,6 +1695,15 @@ static U64 usbd_cdc_acm_ep_bulkin_stack[USBD_CDC_ACM_EP_BULKIN_STACK / 8];
 #if (USBD_CDC_ACM_EP_BULKOUT_STACK > 0)
 static U64 usbd_cdc_acm_ep_bulkout_stack[USBD_CDC_ACM_EP_BULKOUT_STACK / 8];
 #endif
+#if (USBD_BULK_EP_CMDIN_STACK > 0)
+static U64 usbd_bulk_ep_cmdin_stack[USBD_BULK_EP_CMDIN_STACK / 8];
+#endif
+#if (USBD_BULK_EP_CMDOUT_STACK > 0)
+static U64 usbd_bulk_ep_cmdout_stack[USBD_BULK_EP_CMDOUT_STACK / 8];
+#endif
+#if (USBD_BULK_EP_SWOIN_STACK > 0)
+static U64 usbd_bulk_ep_swoin_stack[USBD_BULK_EP_SWOIN_STACK / 8];
+#endif
 
 // Check HID
 #if (USBD_HID_ENABLE && !USBD_HID_EP_INTIN_STACK && USBD_HID_EP_INTIN != USBD_HID_EP_INTOUT)
@@ -1412,6 +1755,23 @@ static U64 usbd_cdc_acm_ep_bulkout_stack[USBD_CDC_ACM_EP_BULKOUT_STACK / 8];
 #error "Multiple CDC stacks defined for same EP"
 #endif
 
+// Check BULK
+#if (USBD_BULK_ENABLE && !USBD_BULK_EP_CMDIN_STACK && USBD_BULK_EP_CMDIN != USBD_BULK_EP_CMDOUT)
+#error "USBD_BULK_EP_CMDIN_STACK must be defined"
+#endif
+#if (USBD_BULK_ENABLE && !USBD_BULK_EP_CMDOUT_STACK && USBD_BULK_EP_CMDIN != USBD_BULK_EP_CMDOUT)
+#error "USBD_BULK_EP_CMDOUT_STACK must be defined"
+#endif
+#if (USBD_BULK_ENABLE && USBD_BULK_EP_CMDOUT != 0 && USBD_BULK_EP_CMDIN_STACK == 0 && USBD_BULK_EP_CMDOUT_STACK == 0)
+#error "BULK CMD stack must be defined"
+#endif
+#if (USBD_BULK_EP_CMDIN_STACK > 0 && USBD_BULK_EP_CMDOUT_STACK > 0 && USBD_BULK_EP_CMDIN == USBD_BULK_EP_CMDOUT)
+#error "Multiple BULK CMD stacks defined for same EP"
+#endif
+#if (USBD_BULK_ENABLE && !USBD_BULK_EP_SWOIN_STACK && USBD_BULK_EP_SWOIN != 0)
+#error "BULK SWOIN stack must be defined"
+#endif
+
 static const user_stack_t user_stack_list[16] = {
 #if USBD_ENABLE
     [0] = {usbd_endpoint0_stack, sizeof(usbd_endpoint0_stack)},
@@ -1440,6 +1800,15 @@ static const user_stack_t user_stack_list[16] = {
 #if (USBD_CDC_ACM_EP_BULKOUT_STACK > 0)
     [USBD_CDC_ACM_EP_BULKOUT] = {usbd_cdc_acm_ep_bulkout_stack, sizeof(usbd_cdc_acm_ep_bulkout_stack)},
 #endif
+#if (USBD_BULK_EP_CMDIN_STACK > 0)
+    [USBD_BULK_EP_CMDIN] = {usbd_bulk_ep_cmdin_stack, sizeof(usbd_bulk_ep_cmdin_stack)},
+#endif
+#if (USBD_BULK_EP_CMDOUT_STACK > 0)
+    [USBD_BULK_EP_CMDOUT] = {usbd_bulk_ep_cmdout_stack, sizeof(usbd_bulk_ep_cmdout_stack)},
+#endif
+#if (USBD_BULK_EP_SWOIN_STACK > 0)
+    [USBD_BULK_EP_SWOIN] = {usbd_bulk_ep_swoin_stack, sizeof(usbd_bulk_ep_swoin_stack)},
+#endif
 };
 
 #endif /* __RTX */
@@ -1501,13 +1870,26 @@ void USBD_RTX_TaskInit(void)
                                            USB_INTERFACE_DESC_SIZE + USB_ENDPOINT_DESC_SIZE + USB_ENDPOINT_DESC_SIZE)
 #define USBD_HID_DESC_LEN                 (USB_INTERFACE_DESC_SIZE + USB_HID_DESC_SIZE                                                          + \
                                           (USB_ENDPOINT_DESC_SIZE*(1+(USBD_HID_EP_INTOUT != 0))))
+/* The command endpoint pair and the SWO trace endpoint are both optional */
+#define USBD_BULK_EP_COUNT                (2*(USBD_BULK_EP_CMDOUT != 0)+(USBD_BULK_EP_SWOIN != 0))
+#define USBD_BULK_DESC_LEN                (USB_INTERFACE_DESC_SIZE                                                                              + \
+                                          (USB_ENDPOINT_DESC_SIZE*USBD_BULK_EP_COUNT))
 #define USBD_HID_DESC_OFS                 (USB_CONFIGUARTION_DESC_SIZE + USB_INTERFACE_DESC_SIZE                                                + \
                                            USBD_MSC_ENABLE * USBD_MSC_DESC_LEN + USBD_CDC_ACM_ENABLE * USBD_CDC_ACM_DESC_LEN)
 
 #define USBD_WTOTALLENGTH                 (USB_CONFIGUARTION_DESC_SIZE +                 \
                                            USBD_CDC_ACM_DESC_LEN * USBD_CDC_ACM_ENABLE + \
                                            USBD_HID_DESC_LEN     * USBD_HID_ENABLE     + \
-                                           USBD_MSC_DESC_LEN     * USBD_MSC_ENABLE)
+                                           USBD_MSC_DESC_LEN     * USBD_MSC_ENABLE     + \
+                                           USBD_BULK_DESC_LEN    * USBD_BULK_ENABLE)
+
+/* Microsoft OS 2.0 descriptor set, the subset headers are only used by a composite device */
+#define USBD_MSOS20_FEATURE_LEN           (20 + /* Compatible ID */                                                                             \
+                                           10 + 42 + 80 /* Registry Property DeviceInterfaceGUIDs */)
+#define USBD_MSOS20_FUNCTION_LEN          (8 + USBD_MSOS20_FEATURE_LEN)
+#define USBD_MSOS20_CONFIG_LEN            (8 + USBD_MSOS20_FUNCTION_LEN)
+#define USBD_MSOS20_DESC_LEN              (10 + ((USBD_IF_NUM > 1) ? USBD_MSOS20_CONFIG_LEN : USBD_MSOS20_FEATURE_LEN))
+#define USBD_BOS_WTOTALLENGTH             (USB_BOS_DESC_SIZE + 28 /* Platform Capability */)
 
 /*------------------------------------------------------------------------------
   Default HID Report Descriptor
@@ -1567,7 +1949,9 @@ __weak \
 const U8 USBD_DeviceDescriptor[] = {
     USB_DEVICE_DESC_SIZE,                 /* bLength */
     USB_DEVICE_DESCRIPTOR_TYPE,           /* bDescriptorType */
-#if ((USBD_HS_ENABLE) || (USBD_MULTI_IF))
+#if (USBD_BULK_ENABLE)
+    WBVAL(0x0210), /* 2.10 */             /* bcdUSB: BOS descriptor supported */
+#elif ((USBD_HS_ENABLE) || (USBD_MULTI_IF))
     WBVAL(0x0200), /* 2.00 */             /* bcdUSB */
 #else
     WBVAL(0x0110), /* 1.10 */             /* bcdUSB */
@@ -1633,6 +2017,82 @@ __weak \
 const U8 USBD_DeviceQualifier_HS[] = { 0 };
 #endif
 
+#if (USBD_BULK_ENABLE)
+/* USB Device Binary Object Store Descriptor, announces the Microsoft OS 2.0
+   descriptor set that binds the vendor bulk interface to WinUSB */
+__weak \
+const U8 USBD_BinaryObjectStoreDescriptor[] = {
+    USB_BOS_DESC_SIZE,                    /* bLength */
+    USB_BINARY_OBJECT_STORE_DESCRIPTOR_TYPE, /* bDescriptorType */
+    WBVAL(USBD_BOS_WTOTALLENGTH),         /* wTotalLength */
+    0x01,                                 /* bNumDeviceCaps */
+    /* Microsoft OS 2.0 Platform Capability Descriptor */
+    28,                                   /* bLength */
+    USB_DEVICE_CAPABILITY_DESCRIPTOR_TYPE, /* bDescriptorType */
+    USB_DEVICE_CAPABILITY_PLATFORM,       /* bDevCapabilityType */
+    0x00,                                 /* bReserved */
+    0xDF, 0x60, 0xDD, 0xD8,               /* PlatformCapabilityUUID */
+    0x89, 0x45, 0xC7, 0x4C,               /* {D8DD60DF-4589-4CC7-9CD2-659D9E648A9F} */
+    0x9C, 0xD2, 0x65, 0x9D,
+    0x9E, 0x64, 0x8A, 0x9F,
+    B4VAL(0x06030000),                    /* dwWindowsVersion: Windows 8.1 */
+    WBVAL(USBD_MSOS20_DESC_LEN),          /* wMSOSDescriptorSetTotalLength */
+    USBD_BULK_MS_VENDOR_CODE,             /* bMS_VendorCode */
+    0x00                                  /* bAltEnumCode */
+};
+
+/* Microsoft OS 2.0 Descriptor Set, returned by the vendor request */
+__weak \
+const U8 USBD_MSOS20DescriptorSet[] = {
+    WBVAL(10),                            /* wLength */
+    WBVAL(MS_OS_20_SET_HEADER_DESCRIPTOR), /* wDescriptorType */
+    B4VAL(0x06030000),                    /* dwWindowsVersion: Windows 8.1 */
+    WBVAL(USBD_MSOS20_DESC_LEN),          /* wTotalLength */
+#if (USBD_IF_NUM > 1)
+    /* Configuration Subset Header */
+    WBVAL(8),                             /* wLength */
+    WBVAL(MS_OS_20_SUBSET_HEADER_CONFIGURATION), /* wDescriptorType */
+    0x00,                                 /* bConfigurationValue: index of the configuration */
+    0x00,                                 /* bReserved */
+    WBVAL(USBD_MSOS20_CONFIG_LEN),        /* wTotalLength */
+    /* Function Subset Header */
+    WBVAL(8),                             /* wLength */
+    WBVAL(MS_OS_20_SUBSET_HEADER_FUNCTION), /* wDescriptorType */
+    USBD_BULK_IF_NUM,                     /* bFirstInterface */
+    0x00,                                 /* bReserved */
+    WBVAL(USBD_MSOS20_FUNCTION_LEN),      /* wSubsetLength */
+#endif
+    /* Compatible ID Descriptor */
+    WBVAL(20),                            /* wLength */
+    WBVAL(MS_OS_20_FEATURE_COMPATIBLE_ID), /* wDescriptorType */
+    'W', 'I', 'N', 'U', 'S', 'B', 0, 0,   /* CompatibleID */
+    0, 0, 0, 0, 0, 0, 0, 0,               /* SubCompatibleID */
+    /* Registry Property Descriptor */
+    WBVAL(10 + 42 + 80),                  /* wLength */
+    WBVAL(MS_OS_20_FEATURE_REG_PROPERTY), /* wDescriptorType */
+    WBVAL(MS_OS_20_REG_MULTI_SZ),         /* wPropertyDataType */
+    WBVAL(42),                            /* wPropertyNameLength */
+    /* PropertyName: "DeviceInterfaceGUIDs" */
+    'D', 0, 'e', 0, 'v', 0, 'i', 0, 'c', 0, 'e', 0, 'I', 0, 'n', 0,
+    't', 0, 'e', 0, 'r', 0, 'f', 0, 'a', 0, 'c', 0, 'e', 0, 'G', 0,
+    'U', 0, 'I', 0, 'D', 0, 's', 0, 0, 0,
+    WBVAL(80),                            /* wPropertyDataLength */
+    /* PropertyData: GUID of the CMSIS-DAP v2 interface */
+    '{', 0, 'C', 0, 'D', 0, 'B', 0, '3', 0, 'B', 0, '5', 0, 'A', 0,
+    'D', 0, '-', 0, '2', 0, '9', 0, '3', 0, 'B', 0, '-', 0, '4', 0,
+    '6', 0, '6', 0, '3', 0, '-', 0, 'A', 0, 'A', 0, '3', 0, '6', 0,
+    '-', 0, '1', 0, 'A', 0, 'A', 0, 'E', 0, '4', 0, '6', 0, '4', 0,
+    '6', 0, '3', 0, '7', 0, '7', 0, '6', 0, '}', 0, 0, 0, 0, 0,
+};
+#else
+__weak \
+const U8 USBD_BinaryObjectStoreDescriptor[] = { 0 };
+__weak \
+const U8 USBD_MSOS20DescriptorSet[] = { 0 };
+#endif
+__weak \
+const U16 USBD_MSOS20DescriptorSetSize = sizeof(USBD_MSOS20DescriptorSet) * USBD_BULK_ENABLE;
+
 #define HID_DESC                                                                                            \
   /* Interface, Alternate Setting 0, HID Class */                                                           \
   USB_INTERFACE_DESC_SIZE,              /* bLength */                                                       \
@@ -1752,6 +2212,68 @@ const U8 USBD_DeviceQualifier_HS[] = { 0 };
   WBVAL(USBD_MSC_HS_WMAXPACKETSIZE),    /* wMaxPacketSize */                                                \
   USBD_MSC_HS_BINTERVAL,                /* bInterval */
 
+#define BULK_DESC                                                                                           \
+/* Interface, Alternate Setting 0, Vendor Specific Class */                                                 \
+  USB_INTERFACE_DESC_SIZE,              /* bLength */                                                       \
+  USB_INTERFACE_DESCRIPTOR_TYPE,        /* bDescriptorType */                                               \
+  USBD_BULK_IF_NUM,                     /* bInterfaceNumber */                                              \
+  0x00,                                 /* bAlternateSetting */                                             \
+  USBD_BULK_EP_COUNT,                   /* bNumEndpoints */                                                 \
+  USB_DEVICE_CLASS_VENDOR_SPECIFIC,     /* bInterfaceClass */                                               \
+  0x00,                                 /* bInterfaceSubClass */                                            \
+  0x00,                                 /* bInterfaceProtocol */                                            \
+  USBD_BULK_IF_STR_NUM,                 /* iInterface */
+
+#define BULK_EP                         /* BULK Endpoints for Low-speed/Full-speed */                       \
+/* Endpoint, EP Bulk OUT (CMSIS-DAP command) */                                                             \
+  USB_ENDPOINT_DESC_SIZE,               /* bLength */                                                       \
+  USB_ENDPOINT_DESCRIPTOR_TYPE,         /* bDescriptorType */                                               \
+  USB_ENDPOINT_OUT(USBD_BULK_EP_CMDOUT),/* bEndpointAddress */                                              \
+  USB_ENDPOINT_TYPE_BULK,               /* bmAttributes */                                                  \
+  WBVAL(USBD_BULK_WMAXPACKETSIZE),      /* wMaxPacketSize */                                                \
+  0x00,                                 /* bInterval: ignore for Bulk transfer */                           \
+/* Endpoint, EP Bulk IN (CMSIS-DAP response) */                                                             \
+  USB_ENDPOINT_DESC_SIZE,               /* bLength */                                                       \
+  USB_ENDPOINT_DESCRIPTOR_TYPE,         /* bDescriptorType */                                               \
+  USB_ENDPOINT_IN(USBD_BULK_EP_CMDIN),  /* bEndpointAddress */                                              \
+  USB_ENDPOINT_TYPE_BULK,               /* bmAttributes */                                                  \
+  WBVAL(USBD_BULK_WMAXPACKETSIZE),      /* wMaxPacketSize */                                                \
+  0x00,                                 /* bInterval: ignore for Bulk transfer */
+
+#define BULK_EP_SWO                     /* BULK SWO Endpoint for Low-speed/Full-speed */                    \
+/* Endpoint, EP Bulk IN (SWO trace) */                                                                      \
+  USB_ENDPOINT_DESC_SIZE,               /* bLength */                                                       \
+  USB_ENDPOINT_DESCRIPTOR_TYPE,         /* bDescriptorType */                                               \
+  USB_ENDPOINT_IN(USBD_BULK_EP_SWOIN),  /* bEndpointAddress */                                              \
+  USB_ENDPOINT_TYPE_BULK,               /* bmAttributes */                                                  \
+  WBVAL(USBD_BULK_WMAXPACKETSIZE),      /* wMaxPacketSize */                                                \
+  0x00,                                 /* bInterval: ignore for Bulk transfer */
+
+#define BULK_EP_HS                      /* BULK Endpoints for High-speed */                                 \
+/* Endpoint, EP Bulk OUT (CMSIS-DAP command) */                                                             \
+  USB_ENDPOINT_DESC_SIZE,               /* bLength */                                                       \
+  USB_ENDPOINT_DESCRIPTOR_TYPE,         /* bDescriptorType */                                               \
+  USB_ENDPOINT_OUT(USBD_BULK_EP_CMDOUT),/* bEndpointAddress */                                              \
+  USB_ENDPOINT_TYPE_BULK,               /* bmAttributes */                                                  \
+  WBVAL(USBD_BULK_HS_WMAXPACKETSIZE),   /* wMaxPacketSize */                                                \
+  USBD_BULK_HS_BINTERVAL,               /* bInterval */                                                     \
+/* Endpoint, EP Bulk IN (CMSIS-DAP response) */                                                             \
+  USB_ENDPOINT_DESC_SIZE,               /* bLength */                                                       \
+  USB_ENDPOINT_DESCRIPTOR_TYPE,         /* bDescriptorType */                                               \
+  USB_ENDPOINT_IN(USBD_BULK_EP_CMDIN),  /* bEndpointAddress */                                              \
+  USB_ENDPOINT_TYPE_BULK,               /* bmAttributes */                                                  \
+  WBVAL(USBD_BULK_HS_WMAXPACKETSIZE),   /* wMaxPacketSize */                                                \
+  USBD_BULK_HS_BINTERVAL,               /* bInterval */
+
+#define BULK_EP_HS_SWO                  /* BULK SWO Endpoint for High-speed */                              \
+/* Endpoint, EP Bulk IN (SWO trace) */                                                                      \
+  USB_ENDPOINT_DESC_SIZE,               /* bLength */                                                       \
+  USB_ENDPOINT_DESCRIPTOR_TYPE,         /* bDescriptorType */                                               \
+  USB_ENDPOINT_IN(USBD_BULK_EP_SWOIN),  /* bEndpointAddress */                                              \
+  USB_ENDPOINT_TYPE_BULK,               /* bmAttributes */                                                  \
+  WBVAL(USBD_BULK_HS_WMAXPACKETSIZE),   /* wMaxPacketSize */                                                \
+  USBD_BULK_HS_BINTERVAL,               /* bInterval */
+
 #define ADC_DESC_IAD(first,num_of_ifs)  /* ADC: Interface Association Descriptor */                         \
   USB_INTERFACE_ASSOC_DESC_SIZE,        /* bLength */                                                       \
   USB_INTERFACE_ASSOCIATION_DESCRIPTOR_TYPE,  /* bDescriptorType */                                         \
@@ -2056,6 +2578,16 @@ const U8 USBD_ConfigDescriptor[] = {
     CDC_ACM_EP_IF1
 #endif
 
+#if (USBD_BULK_ENABLE)
+    BULK_DESC
+#if (USBD_BULK_EP_CMDOUT != 0)
+    BULK_EP
+#endif
+#if (USBD_BULK_EP_SWOIN != 0)
+    BULK_EP_SWO
+#endif
+#endif
+
     /* Terminator */                                                                                            \
     0                                     /* bLength */                                                       \
 };
@@ -2116,6 +2648,16 @@ const U8 USBD_ConfigDescriptor_HS[] = {
     CDC_ACM_EP_IF1_HS
 #endif
 
+#if (USBD_BULK_ENABLE)
+    BULK_DESC
+#if (USBD_BULK_EP_CMDOUT != 0)
+    BULK_EP_HS
+#endif
+#if (USBD_BULK_EP_SWOIN != 0)
+    BULK_EP_HS_SWO
+#endif
+#endif
+
     /* Terminator */                                                                                            \
     0                                     /* bLength */                                                       \
 };
@@ -2167,6 +2709,16 @@ const U8 USBD_OtherSpeedConfigDescriptor[] = {
     MSC_EP_HS
 #endif
 
+#if (USBD_BULK_ENABLE)
+    BULK_DESC
+#if (USBD_BULK_EP_CMDOUT != 0)
+    BULK_EP_HS
+#endif
+#if (USBD_BULK_EP_SWOIN != 0)
+    BULK_EP_HS_SWO
+#endif
+#endif
+
     /* Terminator */
     0                                     /* bLength */
 };
@@ -2218,6 +2770,16 @@ const U8 USBD_OtherSpeedConfigDescriptor_HS[] = {
     MSC_EP
 #endif
 
+#if (USBD_BULK_ENABLE)
+    BULK_DESC
+#if (USBD_BULK_EP_CMDOUT != 0)
+    BULK_EP
+#endif
+#if (USBD_BULK_EP_SWOIN != 0)
+    BULK_EP_SWO
+#endif
+#endif
+
     /* Terminator */
     0                                     /* bLength */
 };
@@ -2261,6 +2823,9 @@ const struct {
 #if (USBD_MSC_ENABLE)
     USBD_STR_DEF(MSC_STRDESC);
 #endif
+#if (USBD_BULK_ENABLE)
+    USBD_STR_DEF(BULK_STRDESC);
+#endif
 } USBD_StringDescriptor
 = {
     { 4, USB_STRING_DESCRIPTOR_TYPE, USBD_STRDESC_LANGID },
@@ -2284,6 +2849,9 @@ const struct {
 #if (USBD_MSC_ENABLE)
     USBD_STR_VAL(MSC_STRDESC),
 #endif
+#if (USBD_BULK_ENABLE)
+    USBD_STR_VAL(BULK_STRDESC),
+#endif
 };
 
 #endif
@@ -92,6 +92,16 @@ extern U8 USBD_CDC_ACM_SendBuf[];
 extern U8 USBD_CDC_ACM_ReceiveBuf[];
 extern U8 USBD_CDC_ACM_NotifyBuf[10];
 
+extern const U8 usbd_bulk_enable;
+extern const U8 usbd_bulk_if_num;
+extern const U8 usbd_bulk_ep_cmdout;
+extern const U8 usbd_bulk_ep_cmdin;
+extern const U8 usbd_bulk_ep_swoin;
+extern const U16 usbd_bulk_maxpacketsize[2];
+extern const U16 usbd_bulk_cmd_max_sz;
+extern const U8 usbd_bulk_ms_vendor_code;
+extern U8 USBD_BULK_CmdBuf[];
+
 extern void usbd_os_evt_set(U16 event_flags, U32 task);
 extern U16 usbd_os_evt_get(void);
 extern U32 usbd_os_evt_wait_or(U16 wait_flags, U16 timeout);
@@ -115,5 +125,8 @@ extern const U8 USBD_OtherSpeedConfigDescriptor_HS[];
 extern const U8 USBD_OtherSpeedConfigDescriptor[];
 extern const U8 USBD_OtherSpeedConfigDescriptor_HS[];
 extern const U8 USBD_StringDescriptor[];
+extern const U8 USBD_BinaryObjectStoreDescriptor[];
+extern const U8 USBD_MSOS20DescriptorSet[];
+extern const U16 USBD_MSOS20DescriptorSetSize;
 
 #endif  /* __USB_LIB_H__ */
@@ -406,6 +406,17 @@ static inline BOOL USBD_ReqGetDescriptor(void)
                     len = ((USB_CONFIGURATION_DESCRIPTOR *)pD)->wTotalLength;
                     break;
 
+                case USB_BINARY_OBJECT_STORE_DESCRIPTOR_TYPE:
+                    pD = (U8 *)USBD_BinaryObjectStoreDescriptor;
+
+                    if (((USB_BINARY_OBJECT_STORE_DESCRIPTOR *)pD)->bLength == 0) {
+                        return (__FALSE);  /* BOS not provided */
+                    }
+
+                    USBD_EP0Data.pData = pD;
+                    len = ((USB_BINARY_OBJECT_STORE_DESCRIPTOR *)pD)->wTotalLength;
+                    break;
+
                 case USB_STRING_DESCRIPTOR_TYPE:
                     pD = (U8 *)USBD_StringDescriptor;
 
@@ -910,6 +921,22 @@ void USBD_EndPoint0(U32 event)
 setup_class_ok:                                                          /* request finished successfully */
                 break;  /* end case REQUEST_CLASS */
 
+            case REQUEST_VENDOR:
+                switch (USBD_SetupPacket.bmRequestType.Recipient) {
+                    case REQUEST_TO_DEVICE:
+                        if (USBD_EndPoint0_Setup_BULK_ReqToDevice()) {
+                            goto setup_vendor_ok;
+                        }
+
+                        goto stall;                                                  /* not supported */
+
+                    default:
+                        goto stall;
+                }
+
+setup_vendor_ok:                                                         /* request finished successfully */
+                break;  /* end case REQUEST_VENDOR */
+
             default:
 stall:
                 if ((USBD_SetupPacket.bmRequestType.Dir == REQUEST_HOST_TO_DEVICE) &&
@@ -22,11 +22,20 @@
 #ifndef __USBD_MSC_H__
 #define __USBD_MSC_H__
 
+/* Set MSC_RAW_LUN to 1 in the project macros to add a second logical unit.
+   It is a raw block device without a filesystem that is only written to. */
+#ifndef MSC_RAW_LUN
+#define MSC_RAW_LUN 0
+#endif
+
+/* Logical unit number of the raw block device */
+#define MSC_LUN_RAW 1
 
 /*--------------------------- Global variables -------------------------------*/
 
 /* USB Device Mass Storage Device Class Global Variables */
 extern BOOL USBD_MSC_MediaReady;
+extern BOOL USBD_MSC_MediaChanged;
 extern BOOL USBD_MSC_ReadOnly;
 extern U32 USBD_MSC_MemorySize;
 extern U32 USBD_MSC_BlockSize;
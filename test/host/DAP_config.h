@@ -0,0 +1,80 @@
+/**
+ * @file    DAP_config.h
+ * @brief   Pin model of a HIC for host tests of the CMSIS-DAP drivers
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DAP_CONFIG_H__
+#define __DAP_CONFIG_H__
+
+#include <stdint.h>
+
+#define __forceinline           inline
+
+#define DAP_SWD                 1
+#define DAP_JTAG                1
+#define DAP_JTAG_DEV_CNT        8
+
+// Every pin access is appended to pin_trace as one character:
+//   C/c TCK high/low, M/m TMS high/low, D/d TDI high/low, r TDO read.
+// TDO reads return the next bit of pin_tdo_seed.
+extern char     pin_trace[];
+extern uint32_t pin_trace_len;
+extern uint32_t pin_tdo_seed;
+
+static __forceinline void pin_log(char event)
+{
+    pin_trace[pin_trace_len++] = event;
+}
+
+static __forceinline void PIN_SWCLK_TCK_SET(void)
+{
+    pin_log('C');
+}
+
+static __forceinline void PIN_SWCLK_TCK_CLR(void)
+{
+    pin_log('c');
+}
+
+static __forceinline void PIN_SWDIO_TMS_SET(void)
+{
+    pin_log('M');
+}
+
+static __forceinline void PIN_SWDIO_TMS_CLR(void)
+{
+    pin_log('m');
+}
+
+static __forceinline void PIN_TDI_OUT(uint32_t bit)
+{
+    pin_log((bit & 0x1) ? 'D' : 'd');
+}
+
+static __forceinline uint32_t PIN_TDO_IN(void)
+{
+    // 32-bit xorshift
+    pin_tdo_seed ^= pin_tdo_seed << 13;
+    pin_tdo_seed ^= pin_tdo_seed >> 17;
+    pin_tdo_seed ^= pin_tdo_seed << 5;
+    pin_log('r');
+    return pin_tdo_seed & 0x1;
+}
+
+#endif
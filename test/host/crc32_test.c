@@ -0,0 +1,173 @@
+/**
+ * @file    crc32_test.c
+ * @brief   Host test and benchmark of the CRC32 kernels in crc32.c
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Build once per kernel from the repository root and run, e.g.
+ *   gcc -O2 -DCRC32_ENGINE=0 -Isource/daplink test/host/crc32_test.c
+ *   ./a.out
+ * with CRC32_ENGINE 0 to 3, and CRC32_ENGINE=3 with -DBROKEN_HAL.
+ * Every kernel is checked against a bitwise reference over aligned,
+ * unaligned and split buffers, then timed. For CRC32_ENGINE_HAL a
+ * software model of the peripheral stands in for crc32_hal_update().
+ * BROKEN_HAL models a peripheral that takes its seed unreflected, so
+ * the self-test must fall back to the nibble kernel.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "crc.h"
+
+#if (CRC32_ENGINE == CRC32_ENGINE_HAL)
+static unsigned long hal_calls;
+
+#ifdef BROKEN_HAL
+static uint32_t reflect(uint32_t value)
+{
+    uint32_t result = 0;
+    int i;
+
+    for (i = 0; i < 32; i++) {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+
+    return result;
+}
+#endif
+
+uint32_t crc32_hal_update(uint32_t remainder, const void *data, int nBytes)
+{
+    const uint8_t *message = data;
+    int i;
+
+    hal_calls++;
+#ifdef BROKEN_HAL
+    remainder = reflect(remainder);
+#endif
+
+    while (nBytes-- > 0) {
+        remainder ^= *message++;
+        for (i = 0; i < 8; i++) {
+            remainder = (remainder >> 1) ^ (0xEDB88320 & -(remainder & 1));
+        }
+    }
+
+    return remainder;
+}
+#endif
+
+#include "../../source/daplink/crc32.c"
+
+static const char *engine_names[] = { "NIBBLE", "SLICE4", "SLICE8", "HAL" };
+static int failures;
+
+static uint32_t reference(const uint8_t *data, size_t size)
+{
+    uint32_t remainder = 0xFFFFFFFF;
+    int i;
+
+    while (size-- > 0) {
+        remainder ^= *data++;
+        for (i = 0; i < 8; i++) {
+            remainder = (remainder >> 1) ^ (0xEDB88320 & -(remainder & 1));
+        }
+    }
+
+    return remainder ^ 0xFFFFFFFF;
+}
+
+static void expect(const char *what, size_t offset, size_t size, uint32_t got, uint32_t want)
+{
+    if (got != want) {
+        printf("FAIL %s offset=%u size=%u got=%08X want=%08X\n", what,
+               (unsigned)offset, (unsigned)size, (unsigned)got, (unsigned)want);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    static uint8_t buf[1 << 20];
+    size_t offset;
+    size_t size;
+    size_t split;
+    uint32_t want;
+    uint32_t remainder;
+    clock_t start;
+    double seconds;
+    int runs;
+    int i;
+
+    expect("check", 0, 9, crc32("123456789", 9), CHECK_VALUE);
+
+    srand(1);
+    for (i = 0; i < (int)sizeof(buf); i++) {
+        buf[i] = rand();
+    }
+
+    for (offset = 0; offset < 8; offset++) {
+        for (size = 0; size < 80; size++) {
+            want = reference(buf + offset, size);
+            expect("crc32", offset, size, crc32(buf + offset, size), want);
+            for (split = 0; split <= size; split++) {
+                remainder = crc32_init();
+                remainder = crc32_update(remainder, buf + offset, split);
+                remainder = crc32_update(remainder, buf + offset + split, size - split);
+                expect("update", offset, split, crc32_final(remainder), want);
+                expect("continue", offset, split,
+                       crc32_continue(crc32(buf + offset, split), buf + offset + split, size - split), want);
+            }
+        }
+    }
+
+#if (CRC32_ENGINE == CRC32_ENGINE_HAL)
+#ifdef BROKEN_HAL
+    // Only the self-test may reach a peripheral that failed it
+    if ((hal_status != HAL_FAILED) || (hal_calls != 3)) {
+        printf("FAIL broken peripheral still in use\n");
+        failures++;
+    }
+#else
+    if (hal_status != HAL_PASSED) {
+        printf("FAIL working peripheral failed the self-test\n");
+        failures++;
+    }
+#endif
+    printf("peripheral self-test %s, %lu peripheral calls\n",
+           hal_status == HAL_PASSED ? "passed" : "failed", hal_calls);
+#endif
+
+    want = reference(buf, sizeof(buf));
+    runs = 0;
+    start = clock();
+    do {
+        expect("bench", 0, sizeof(buf), crc32(buf, sizeof(buf)), want);
+        runs++;
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    } while (seconds < 0.5);
+
+    printf("%s: %s, %.1f MB/s\n", engine_names[CRC32_ENGINE],
+           failures ? "FAIL" : "pass", runs * (sizeof(buf) / 1048576.0) / seconds);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,238 @@
+/**
+ * @file    intelhex_bench.c
+ * @brief   Host test and benchmark of the hex parser in intelhex.c
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Build from the repository root and run:
+ *   gcc -O2 -Isource/daplink/drag-n-drop test/host/intelhex_bench.c
+ *   ./a.out
+ * Add -DHEX_BUFFER_SIZE=1024 for the lpc4322 buffer size.
+ * Generated hex files are fed to parse_hex_blob() in sector sized and
+ * odd sized chunks, buffered the way write_hex() and close_hex() in
+ * file_stream.c do. The programmed data must match the generated
+ * image, then decode speed and the number of flash writes are shown.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../source/daplink/drag-n-drop/intelhex.c"
+
+#ifndef HEX_BUFFER_SIZE
+#define HEX_BUFFER_SIZE 256
+#endif
+
+#define IMAGE_SIZE      0x200000
+#define FILE_SIZE       0x800000
+
+// Generated image and the one rebuilt from flash writes
+static uint8_t image[IMAGE_SIZE];
+static uint8_t image_set[IMAGE_SIZE];
+static uint8_t flash[IMAGE_SIZE];
+static uint8_t flash_set[IMAGE_SIZE];
+static uint32_t flash_writes;
+
+static char file[FILE_SIZE];
+static uint32_t file_size;
+
+static uint8_t bin_buffer[HEX_BUFFER_SIZE];
+static uint32_t bin_address;
+static uint32_t bin_count;
+
+static int failures;
+
+static void emit_record(uint8_t type, uint16_t offset, const uint8_t *data, uint8_t count, int lower)
+{
+    const char *digits = lower ? "0123456789abcdef" : "0123456789ABCDEF";
+    uint8_t header[4] = { count, offset >> 8, offset & 0xFF, type };
+    uint8_t sum = 0;
+    int i;
+
+    file[file_size++] = ':';
+    for (i = 0; i < 4 + count + 1; i++) {
+        uint8_t value = i < 4 ? header[i] : (i < 4 + count ? data[i - 4] : -sum);
+        sum += value;
+        file[file_size++] = digits[value >> 4];
+        file[file_size++] = digits[value & 0xF];
+    }
+    file[file_size++] = '\r';
+    file[file_size++] = '\n';
+}
+
+// Build a hex file of size bytes of data in count byte records. Up to
+// max_gap bytes are skipped after each record.
+static void generate(uint32_t size, uint8_t count, uint32_t max_gap, int lower, int eof)
+{
+    uint32_t address = 0;
+    uint32_t upper = 0xFFFFFFFF;
+    uint8_t data[255];
+    uint8_t ext[2];
+    uint32_t n;
+    uint32_t i;
+
+    memset(image_set, 0, sizeof(image_set));
+    file_size = 0;
+
+    while (address + count <= size) {
+        if ((address >> 16) != upper) {
+            upper = address >> 16;
+            ext[0] = upper >> 8;
+            ext[1] = upper & 0xFF;
+            emit_record(4, 0, ext, 2, lower);
+        }
+
+        // Records do not cross a 64KB boundary
+        n = 0x10000 - (address & 0xFFFF);
+        n = n < count ? n : count;
+
+        for (i = 0; i < n; i++) {
+            data[i] = rand();
+            image[address + i] = data[i];
+            image_set[address + i] = 1;
+        }
+
+        emit_record(0, address & 0xFFFF, data, n, lower);
+        address += n + (max_gap ? rand() % (max_gap + 1) : 0);
+    }
+
+    if (eof) {
+        emit_record(1, 0, NULL, 0, lower);
+    }
+}
+
+static void flash_write(uint32_t address, const uint8_t *data, uint32_t size)
+{
+    memcpy(&flash[address], data, size);
+    memset(&flash_set[address], 1, size);
+    flash_writes++;
+}
+
+// Same buffering as write_hex() in file_stream.c
+static int write_hex(const uint8_t *data, uint32_t size)
+{
+    hexfile_parse_status_t status;
+    uint32_t parsed;
+
+    while (1) {
+        status = parse_hex_blob(data, size, &parsed, bin_buffer, sizeof(bin_buffer), &bin_address, &bin_count);
+        size -= parsed;
+        data += parsed;
+
+        if (HEX_PARSE_OK == status) {
+            return 0;
+        } else if ((HEX_PARSE_UNALIGNED == status) || (HEX_PARSE_EOF == status)) {
+            if (bin_count > 0) {
+                flash_write(bin_address, bin_buffer, bin_count);
+                bin_count = 0;
+            }
+
+            if (HEX_PARSE_EOF == status) {
+                return 1;
+            }
+        } else {
+            return -1;
+        }
+    }
+}
+
+// Same as close_hex() in file_stream.c
+static void close_hex(void)
+{
+    if (bin_count > 0) {
+        flash_write(bin_address, bin_buffer, bin_count);
+        bin_count = 0;
+    }
+}
+
+static int decode(uint32_t chunk)
+{
+    uint32_t pos;
+    int status = 0;
+
+    reset_hex_parser();
+    bin_count = 0;
+    flash_writes = 0;
+
+    for (pos = 0; (pos < file_size) && (0 == status); pos += chunk) {
+        status = write_hex((uint8_t *)file + pos, pos + chunk < file_size ? chunk : file_size - pos);
+    }
+
+    close_hex();
+    return status;
+}
+
+static void run(const char *name, uint32_t size, uint8_t count, uint32_t max_gap, int lower, int eof)
+{
+    static const uint32_t chunks[] = { 512, 61 };
+    clock_t start;
+    double seconds;
+    uint32_t address;
+    uint32_t i;
+    int runs;
+    int status;
+
+    generate(size, count, max_gap, lower, eof);
+
+    for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        memset(flash_set, 0, sizeof(flash_set));
+        status = decode(chunks[i]);
+
+        if ((status != eof) || memcmp(flash_set, image_set, sizeof(image_set))) {
+            printf("FAIL %s chunk=%u status=%d\n", name, chunks[i], status);
+            failures++;
+            continue;
+        }
+
+        for (address = 0; address < IMAGE_SIZE; address++) {
+            if (image_set[address] && (flash[address] != image[address])) {
+                printf("FAIL %s chunk=%u data at 0x%X\n", name, chunks[i], address);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    runs = 0;
+    start = clock();
+    do {
+        decode(512);
+        runs++;
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    } while (seconds < 0.5);
+
+    printf("%-24s %8u hex bytes %6u writes %7.1f MB/s\n", name, file_size,
+           flash_writes, runs * (file_size / 1048576.0) / seconds);
+}
+
+int main(void)
+{
+    srand(1);
+    printf("HEX_BUFFER_SIZE %u\n", HEX_BUFFER_SIZE);
+    run("1MB, 16 byte records", 0x100000, 16, 0, 0, 1);
+    run("512KB, 32 byte, lower", 0x80000, 32, 0, 1, 1);
+    run("256KB, gaps", 0x40000, 32, 40, 0, 1);
+    run("256KB, 255 byte records", 0x40000, 255, 0, 0, 1);
+    run("64KB, no EOF record", 0x10000, 16, 0, 0, 0);
+    printf("intelhex: %s\n", failures ? "FAIL" : "pass");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,318 @@
+/**
+ * @file    jtag_dp_test.c
+ * @brief   Host test of the JTAG bit shifting in JTAG_DP.c
+ *
+ * DAPLink Interface Firmware
+ * Copyright (c) 2009-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Build from the repository root and run:
+ *   gcc -O2 -Itest/host -Isource/daplink/cmsis-dap test/host/jtag_dp_test.c
+ *   ./a.out
+ * JTAG_Sequence, JTAG_IR and JTAG_Transfer are run at both clock
+ * speeds against bit at a time reference versions over random chains,
+ * data and TDO input. The pin trace from DAP_config.h and the captured
+ * data must be identical.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../source/daplink/cmsis-dap/JTAG_DP.c"
+
+#define TRACE_SIZE  0x10000
+
+char     pin_trace[TRACE_SIZE];
+uint32_t pin_trace_len;
+uint32_t pin_tdo_seed;
+
+DAP_Data_t DAP_Data;
+
+static char ref_trace[TRACE_SIZE];
+static uint32_t ref_trace_len;
+static int failures;
+
+// Reference versions, one bit per loop iteration
+
+static void ref_Sequence(uint32_t info, const uint8_t *tdi, uint8_t *tdo)
+{
+    uint32_t i_val;
+    uint32_t o_val;
+    uint32_t bit;
+    uint32_t n, k;
+
+    n = info & JTAG_SEQUENCE_TCK;
+    if (n == 0U) {
+        n = 64U;
+    }
+
+    if (info & JTAG_SEQUENCE_TMS) {
+        PIN_TMS_SET();
+    } else {
+        PIN_TMS_CLR();
+    }
+
+    while (n) {
+        i_val = *tdi++;
+        o_val = 0U;
+        for (k = 8U; k && n; k--, n--) {
+            JTAG_CYCLE_TDIO(i_val, bit);
+            i_val >>= 1;
+            o_val >>= 1;
+            o_val |= bit << 7;
+        }
+        o_val >>= k;
+        if (info & JTAG_SEQUENCE_TDO) {
+            *tdo++ = (uint8_t)o_val;
+        }
+    }
+}
+
+static void ref_IR(uint32_t ir)
+{
+    uint32_t n;
+
+    PIN_TMS_SET();
+    JTAG_CYCLE_TCK();
+    JTAG_CYCLE_TCK();
+    PIN_TMS_CLR();
+    JTAG_CYCLE_TCK();
+    JTAG_CYCLE_TCK();
+
+    PIN_TDI_OUT(1U);
+    for (n = DAP_Data.jtag_dev.ir_before[DAP_Data.jtag_dev.index]; n; n--) {
+        JTAG_CYCLE_TCK();
+    }
+    for (n = DAP_Data.jtag_dev.ir_length[DAP_Data.jtag_dev.index] - 1U; n; n--) {
+        JTAG_CYCLE_TDI(ir);
+        ir >>= 1;
+    }
+    n = DAP_Data.jtag_dev.ir_after[DAP_Data.jtag_dev.index];
+    if (n) {
+        JTAG_CYCLE_TDI(ir);
+        PIN_TDI_OUT(1U);
+        for (--n; n; n--) {
+            JTAG_CYCLE_TCK();
+        }
+        PIN_TMS_SET();
+        JTAG_CYCLE_TCK();
+    } else {
+        PIN_TMS_SET();
+        JTAG_CYCLE_TDI(ir);
+    }
+
+    JTAG_CYCLE_TCK();
+    PIN_TMS_CLR();
+    JTAG_CYCLE_TCK();
+    PIN_TDI_OUT(1U);
+}
+
+static uint8_t ref_Transfer(uint32_t request, uint32_t *data)
+{
+    uint32_t ack;
+    uint32_t bit;
+    uint32_t val;
+    uint32_t n;
+
+    PIN_TMS_SET();
+    JTAG_CYCLE_TCK();
+    PIN_TMS_CLR();
+    JTAG_CYCLE_TCK();
+    JTAG_CYCLE_TCK();
+
+    for (n = DAP_Data.jtag_dev.index; n; n--) {
+        JTAG_CYCLE_TCK();
+    }
+
+    JTAG_CYCLE_TDIO(request >> 1, bit);
+    ack  = bit << 1;
+    JTAG_CYCLE_TDIO(request >> 2, bit);
+    ack |= bit << 0;
+    JTAG_CYCLE_TDIO(request >> 3, bit);
+    ack |= bit << 2;
+
+    if (ack != DAP_TRANSFER_OK) {
+        PIN_TMS_SET();
+        JTAG_CYCLE_TCK();
+        goto exit;
+    }
+
+    if (request & DAP_TRANSFER_RnW) {
+        val = 0U;
+        for (n = 31U; n; n--) {
+            JTAG_CYCLE_TDO(bit);
+            val  |= bit << 31;
+            val >>= 1;
+        }
+        n = DAP_Data.jtag_dev.count - DAP_Data.jtag_dev.index - 1U;
+        if (n) {
+            JTAG_CYCLE_TDO(bit);
+            for (--n; n; n--) {
+                JTAG_CYCLE_TCK();
+            }
+            PIN_TMS_SET();
+            JTAG_CYCLE_TCK();
+        } else {
+            PIN_TMS_SET();
+            JTAG_CYCLE_TDO(bit);
+        }
+        val |= bit << 31;
+        if (data) {
+            *data = val;
+        }
+    } else {
+        val = *data;
+        for (n = 31U; n; n--) {
+            JTAG_CYCLE_TDI(val);
+            val >>= 1;
+        }
+        n = DAP_Data.jtag_dev.count - DAP_Data.jtag_dev.index - 1u;
+        if (n) {
+            JTAG_CYCLE_TDI(val);
+            for (--n; n; n--) {
+                JTAG_CYCLE_TCK();
+            }
+            PIN_TMS_SET();
+            JTAG_CYCLE_TCK();
+        } else {
+            PIN_TMS_SET();
+            JTAG_CYCLE_TDI(val);
+        }
+    }
+
+exit:
+    JTAG_CYCLE_TCK();
+    PIN_TMS_CLR();
+    JTAG_CYCLE_TCK();
+    PIN_TDI_OUT(1U);
+
+    n = DAP_Data.transfer.idle_cycles;
+    while (n--) {
+        JTAG_CYCLE_TCK();
+    }
+
+    return ((uint8_t)ack);
+}
+
+// Start a run with the given TDO input
+static void start(uint32_t seed)
+{
+    pin_trace_len = 0;
+    pin_tdo_seed = seed;
+}
+
+// Keep the trace of the reference run
+static void keep(void)
+{
+    memcpy(ref_trace, pin_trace, pin_trace_len);
+    ref_trace_len = pin_trace_len;
+}
+
+static void compare(const char *what, uint32_t arg, int same_output)
+{
+    if ((pin_trace_len != ref_trace_len) ||
+            memcmp(pin_trace, ref_trace, pin_trace_len) || !same_output) {
+        printf("FAIL %s fast=%u arg=0x%08X\n", what, DAP_Data.fast_clock, arg);
+        failures++;
+    }
+}
+
+static void random_chain(void)
+{
+    uint32_t i;
+
+    DAP_Data.jtag_dev.count = 1 + rand() % DAP_JTAG_DEV_CNT;
+    DAP_Data.jtag_dev.index = rand() % DAP_Data.jtag_dev.count;
+    for (i = 0; i < DAP_JTAG_DEV_CNT; i++) {
+        DAP_Data.jtag_dev.ir_length[i] = 1 + rand() % 32;
+        DAP_Data.jtag_dev.ir_before[i] = rand() % 40;
+        DAP_Data.jtag_dev.ir_after[i] = rand() % 40;
+    }
+    DAP_Data.transfer.idle_cycles = rand() % 4;
+}
+
+int main(void)
+{
+    uint8_t tdi[8];
+    uint8_t tdo[8];
+    uint8_t ref_tdo[8];
+    uint32_t info;
+    uint32_t seed;
+    uint32_t ir;
+    uint32_t request;
+    uint32_t data;
+    uint32_t ref_data;
+    uint8_t ack;
+    uint8_t ref_ack;
+    int fast;
+    int i;
+
+    srand(1);
+    DAP_Data.clock_delay = 1;
+
+    for (fast = 0; fast < 2; fast++) {
+        DAP_Data.fast_clock = fast;
+
+        for (info = 0; info < 0x100; info++) {
+            for (i = 0; i < 64; i++) {
+                for (data = 0; data < sizeof(tdi); data++) {
+                    tdi[data] = rand();
+                }
+                seed = rand() | 1;
+                memset(ref_tdo, 0xA5, sizeof(ref_tdo));
+                memset(tdo, 0xA5, sizeof(tdo));
+                start(seed);
+                ref_Sequence(info, tdi, ref_tdo);
+                keep();
+                start(seed);
+                JTAG_Sequence(info, tdi, tdo);
+                compare("JTAG_Sequence", info, !memcmp(tdo, ref_tdo, sizeof(tdo)));
+            }
+        }
+
+        for (i = 0; i < 20000; i++) {
+            random_chain();
+            ir = rand() ^ ((uint32_t)rand() << 16);
+            seed = rand() | 1;
+            start(seed);
+            ref_IR(ir);
+            keep();
+            start(seed);
+            JTAG_IR(ir);
+            compare("JTAG_IR", ir, 1);
+        }
+
+        for (i = 0; i < 200000; i++) {
+            random_chain();
+            request = rand() % 16;
+            data = rand() ^ ((uint32_t)rand() << 16);
+            ref_data = data;
+            seed = rand() | 1;
+            start(seed);
+            ref_ack = ref_Transfer(request, &ref_data);
+            keep();
+            start(seed);
+            ack = JTAG_Transfer(request, &data);
+            compare("JTAG_Transfer", request, (ack == ref_ack) && (data == ref_data));
+        }
+    }
+
+    printf("JTAG_DP: %s\n", failures ? "FAIL" : "pass");
+
+    return failures ? 1 : 0;
+}
@@ -28,22 +28,29 @@ CFG_KEY = 0x6b766c64
 # 8  - auto_rst
 # 8  - automation_allowed
 # 8  - overflow_detect
+# 8  - remount_in_place
+# 8  - memory_files
 # 0  - 'end' member omitted
-FORMAT = '<LHBBB'
+FORMAT = '<LHBBBBB'
 FORMAT_LENGTH = struct.calcsize(FORMAT)
+# Commit word at the end of the 16 byte record, see settings_rom.c
+CFG_COMMIT = 0x6b636d74
+COMMIT_OFFSET = 12
 MINIMUM_ALIGN = 1 << 10  # 1k aligned
 
 
 def create_hex(filename, addr, auto_rst, automation_allowed,
-               overflow_detect, pad_size):
+               overflow_detect, remount_in_place, memory_files, pad_size):
     file_format = 'hex'
     intel_hex = IntelHex()
     intel_hex.puts(addr, struct.pack(FORMAT, CFG_KEY, FORMAT_LENGTH, auto_rst,
-                                     automation_allowed, overflow_detect))
+                                     automation_allowed, overflow_detect,
+                                     remount_in_place, memory_files))
     pad_addr = addr + FORMAT_LENGTH
     pad_byte_count = pad_size - (FORMAT_LENGTH % pad_size)
     pad_data = '\xFF' * pad_byte_count
     intel_hex.puts(pad_addr, pad_data)
+    intel_hex.puts(addr + COMMIT_OFFSET, struct.pack('<L', CFG_COMMIT))
     with open(filename, 'wb') as f:
         intel_hex.tofile(f, file_format)
 
@@ -58,6 +65,8 @@ parser.add_argument("--addr", type=str_to_int, required=True, help="Address of c
 parser.add_argument("--auto_rst", type=int, required=True, choices=[0, 1], help="Auto reset configuration value")
 parser.add_argument("--automation_allowed", type=int, required=True, choices=[0,1], help="Allow automation from filesystem interaction")
 parser.add_argument("--overflow_detect", type=int, required=True, choices=[0,1], help="Enable detection of UART overflow")
+parser.add_argument("--remount_in_place", type=int, default=0, choices=[0,1], help="Signal drive updates with a media change instead of re-enumerating")
+parser.add_argument("--memory_files", type=int, default=0, choices=[0,1], help="Show the target memory as FLASH.BIN and RAM.BIN")
 parser.add_argument("--pad", type=int, default=16, choices=POWERS_OF_TWO, metavar="{1, 2, 4,...}", help="Byte aligned boundary to pad region to")
 parser.add_argument("--output_file", type=str, default='settings.hex', help="Name of output file")
 
@@ -74,9 +83,12 @@ def main():
     print "  auto_rst: %i" % args.auto_rst
     print "  automation_allowed: %i" % args.automation_allowed
     print "  overflow_detect: %i" % args.overflow_detect
+    print "  remount_in_place: %i" % args.remount_in_place
+    print "  memory_files: %i" % args.memory_files
     print ""
     create_hex(args.output_file, args.addr, args.auto_rst,
-               args.automation_allowed, args.overflow_detect, args.pad)
+               args.automation_allowed, args.overflow_detect,
+               args.remount_in_place, args.memory_files, args.pad)
 
 if __name__ == '__main__':
     main()